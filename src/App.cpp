@@ -4,25 +4,119 @@
 #include "implot.h"
 #endif
 
-static std::vector<Game> LoadDemoGames() {
-	Game g1{ "Mental II", 0.9606f, 0.3141f, 0.95f, 99999.0f, {
-		{"Xbet", 0.9609f, 0.40f, false},
-		{"Bloodletting Spins (100x)", 0.9611f, 100.0f, false}
-	} };
-	Game g2{ "Reactoonz", 0.9651f, 0.42f, 0.55f, 4750.0f, {
-	} };
-	Game g3{ "Blood & Shadow 2", 0.9609f, 0.2714f, 0.85f, 16161.0f, {
-		{"Xbet", 0.9605f, 1.50f, false},
-		{"Bonus Buy (100x)", 0.9603f, 100.0f, false}
-	} };
-	return { g1,g2,g3 };
+SlotPlannerApp::SlotPlannerApp() {
+	catalog_.Assign(DemoGames());
 }
 
-SlotPlannerApp::SlotPlannerApp() {
-	games_ = LoadDemoGames();
+bool SlotPlannerApp::OpenCatalog(const std::string& path) {
+	std::string err;
+	if (!catalog_.Load(path, &err)) { catalog_status_ = err; return false; }
+	catalog_status_ = "Loaded " + std::to_string(catalog_.Size()) + " games";
+	game_idx_ = 0;
+	game_matches_dirty_ = true;
+	ranking_.Stop();
+	ranking_.Rows().clear();
+	rank_rows_.clear();
+	session_job_.Cancel();
+	band_job_.Cancel();
+	dep_result_.Invalidate();
+	dep_bands_.Invalidate();
+	deps_pending_ = false;
+	has_result_ = false;
+	bands_dirty_ = true;
+	return true;
+}
+
+// Recomputes what the last edits made stale. Plan numbers follow every edit; simulations
+// wait until the inputs settle (no active widget, no change for Debouncer::kQuietMs)
+// unless forced, and only the stale ones rerun.
+void SlotPlannerApp::UpdateDeps(bool force) {
+	const Game& g = catalog_.Get(game_idx_);
+	const uint64_t k_game = deps::GameKey(game_idx_, g);
+	const uint64_t k_plan = deps::PlanKey(k_game, input_);
+	const uint64_t k_result = deps::Mix(deps::ResultKey(k_plan, input_), int(engine_));
+	const uint64_t k_bands = deps::Mix(deps::Mix(deps::Mix(k_result, band_res_.points), band_res_.log_spaced), band_budget_mb_);
+
+	if (dep_game_.Stale(k_game)) { ComputeEffectiveGame(g, eff_rtp_, eff_cost_); dep_game_.Mark(k_game); }
+	if (!has_result_) return;
+
+	// the plan and preview follow every edit but never build feature tables here: those take
+	// a frame's budget each, so the preview keeps the last settled game's until edits stop
+	auto refresh_preview = [&] {
+		SessionSetup su = PlanSession(g, input_);
+		su.extras = preview_extras_;
+		preview_ = DiffusionPreview(g, input_, su);
+	};
+	if (dep_plan_.Stale(k_plan)) {
+		SimResult r = PlanSession(g, input_).plan;
+		r.prob_ruin = result_.prob_ruin; r.prob_hit_target = result_.prob_hit_target; r.expected_end = result_.expected_end;
+		result_ = r;
+		if (!dep_extras_.Stale(k_game)) refresh_preview();
+		dep_plan_.Mark(k_plan);
+	}
+
+	const bool result_stale = dep_result_.Stale(k_result), bands_stale = dep_bands_.Stale(k_bands);
+	if (result_stale) session_job_.Cancel(); // its trials answer the old question
+	debounce_.Observe(k_bands, ImGui::IsAnyItemActive());
+	deps_pending_ = result_stale || bands_stale;
+	if (!deps_pending_ || (!force && !debounce_.Settled())) return;
+
+	if (dep_extras_.Stale(k_game)) {
+		preview_extras_ = PrepareExtras(g);
+		dep_extras_.Mark(k_game);
+		refresh_preview();
+	}
+	if (result_stale) {
+		session_job_.Start(g, input_, engine_);
+		result_ = session_job_.Result();
+		dep_result_.Mark(k_result);
+	}
+	if (bands_stale) { bands_dirty_ = true; dep_bands_.Mark(k_bands); }
+	deps_pending_ = false;
+}
+
+// Advances the session and band jobs until budget_ms has passed.
+void SlotPlannerApp::PumpJobs(double budget_ms) {
+	const auto deadline = simjob::Clock::now() + std::chrono::duration_cast<simjob::Clock::duration>(std::chrono::duration<double, std::milli>(budget_ms));
+	if (session_job_.Running()) {
+		session_job_.Step(deadline);
+		result_ = session_job_.Result();
+	}
+#ifdef USE_IMPLOT
+	if (has_result_ && (bands_dirty_ || (!bands_valid_ && !band_job_.Running()))) {
+		const Game& g = catalog_.Get(game_idx_);
+		band_job_.Start(g, input_, PlanBands(g, input_, band_res_, size_t(band_budget_mb_) << 20), &band_arena_);
+		band_refreshes_seen_ = 0;
+		bands_dirty_ = false;
+	}
+	if (band_job_.Running()) band_job_.Step(deadline);
+	// every refresh replaces the chart, the first one lands within a frame or two
+	if ((band_job_.Running() || band_job_.Finished()) && band_job_.Refreshes() != band_refreshes_seen_) {
+		band_refreshes_seen_ = band_job_.Refreshes();
+		band_plan_ = band_job_.Plan();
+		bands_ = band_job_.Bands();
+		bands_valid_ = true;
+		++bands_version_;
+
+		auto find_minmax = [](const std::vector<float>& v, float& mn, float& mx) {
+			for (float f : v) { mn = std::min(mn, f); mx = std::max(mx, f); }
+			};
+		bands_ymin_ = FLT_MAX; bands_ymax_ = -FLT_MAX;
+		find_minmax(bands_.p10, bands_ymin_, bands_ymax_);
+		find_minmax(bands_.p90, bands_ymin_, bands_ymax_);
+
+		float pad = std::max(1.0f, (bands_ymax_ - bands_ymin_) * 0.05f);
+		bands_ymin_ -= pad; bands_ymax_ += pad;
+	}
+#else
+	bands_dirty_ = false; // no chart to compute bands for
+#endif
 }
 
 void SlotPlannerApp::Draw() {
+	SP_PROFILE_SCOPE("UI");
+	UpdateDeps();
+	PumpJobs(kFrameBudgetMs);
 
 	ImGuiViewport* vp = ImGui::GetMainViewport();
 	ImGui::SetNextWindowPos(vp->Pos);
@@ -34,6 +128,7 @@ void SlotPlannerApp::Draw() {
 		| ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoNavFocus | ImGuiWindowFlags_NoSavedSettings);
 	if (ImGui::BeginMenuBar()) {
 		if (ImGui::BeginMenu("File")) {
+			if (ImGui::MenuItem("Open catalog...")) open_catalog_ = true;
 			if (ImGui::MenuItem("Exit")) {
 				exit(0); //kek
 			}
@@ -41,11 +136,26 @@ void SlotPlannerApp::Draw() {
 		}
 		if (ImGui::BeginMenu("View")) {
 			ImGui::MenuItem("Advanced Panel", nullptr, &show_advanced_);
+			ImGui::MenuItem("Catalog Ranking", nullptr, &show_ranking_);
+			ImGui::MenuItem("Compare Plans", nullptr, &show_compare_);
+			ImGui::MenuItem("Campaign", nullptr, &show_campaign_);
+			ImGui::MenuItem("Perf", nullptr, &show_perf_);
 			ImGui::EndMenu();
 		}
 		ImGui::EndMenuBar();
 	}
 
+	if (open_catalog_) { ImGui::OpenPopup("Open catalog"); open_catalog_ = false; }
+	if (ImGui::BeginPopupModal("Open catalog", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+		ImGui::InputText("Path", catalog_path_, IM_ARRAYSIZE(catalog_path_));
+		ImGui::TextDisabled(".csv (authoring) or .spcat (compiled, memory-mapped)");
+		if (ImGui::Button("Open") && OpenCatalog(catalog_path_)) ImGui::CloseCurrentPopup();
+		ImGui::SameLine();
+		if (ImGui::Button("Cancel")) ImGui::CloseCurrentPopup();
+		if (!catalog_status_.empty()) ImGui::TextWrapped("%s", catalog_status_.c_str());
+		ImGui::EndPopup();
+	}
+
 	float w = ImGui::GetContentRegionAvail().x;
 	float col_w = std::max(300.0f, w * 0.38f);
 
@@ -64,6 +174,322 @@ void SlotPlannerApp::Draw() {
 	ImGui::EndGroup();
 
 	ImGui::End();
+
+	if (show_ranking_) DrawRanking();
+	if (show_compare_) DrawCompare();
+	if (show_campaign_) DrawCampaign();
+	if (show_perf_) DrawPerf();
+}
+
+void SlotPlannerApp::DrawCompare() {
+	ImGui::SetNextWindowSize({ 620, 560 }, ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Compare Plans", &show_compare_)) { ImGui::End(); return; }
+	Game& g = catalog_.Get(game_idx_);
+	ImGui::TextWrapped("A is the current setup on %s. B is A with the changes below. Both replay the same random numbers trial by trial.", g.name.c_str());
+
+	ImGui::SeparatorText("A");
+	DrawStrategyEditor("a", input_.strategy, g); // the main plan's, so A stays the current setup
+
+	if (cmp_extras_b_.size() != g.extras.size()) {
+		cmp_extras_b_.resize(g.extras.size());
+		for (size_t i = 0; i < g.extras.size(); ++i) cmp_extras_b_[i] = g.extras[i].enabled;
+	}
+	Game game_b = g;
+	for (size_t i = 0; i < game_b.extras.size(); ++i) game_b.extras[i].enabled = cmp_extras_b_[i];
+
+	ImGui::SeparatorText("B");
+	DrawStrategyEditor("b", cmp_strategy_b_, game_b);
+	ImGui::RadioButton("Conservative", &cmp_risk_b_, (int)RiskProfile::Conservative); ImGui::SameLine();
+	ImGui::RadioButton("Balanced", &cmp_risk_b_, (int)RiskProfile::Balanced); ImGui::SameLine();
+	ImGui::RadioButton("Aggressive", &cmp_risk_b_, (int)RiskProfile::Aggressive);
+	ImGui::InputFloat("Starting balance (0 = same)", &cmp_bankroll_b_, 1.0f, 10.0f, "%.2f");
+	for (size_t i = 0; i < g.extras.size(); ++i) {
+		bool on = cmp_extras_b_[i];
+		ImGui::PushID((int)i);
+		if (ImGui::Checkbox(g.extras[i].name.c_str(), &on)) cmp_extras_b_[i] = on;
+		ImGui::PopID();
+	}
+	ImGui::SliderInt("Trials##cmp", &cmp_trials_, 200, 20000);
+
+	if (comparison_.Running()) {
+		ImGui::ProgressBar(float(comparison_.Done()) / std::max(1, comparison_.Total()), { -120, 0 });
+		ImGui::SameLine();
+		if (ImGui::Button("Cancel", { -1, 0 })) comparison_.Stop();
+	}
+	else {
+		if (comparison_.Finished() && !comparison_.Cancelled() && !comparison_.Runs().empty()) {
+			cmp_runs_ = std::move(comparison_.Runs());
+			comparison_.Runs().clear();
+		}
+		if (ImGui::Button("Compare", { -1, 0 })) {
+			CompareConfig a{ "A", g, input_ }, b{ "B", game_b, input_ };
+			b.in.strategy = cmp_strategy_b_;
+			b.in.risk = (RiskProfile)cmp_risk_b_;
+			if (cmp_bankroll_b_ >= 1.f) b.in.start_bankroll = cmp_bankroll_b_;
+			CompareOptions opt;
+			opt.trials = cmp_trials_;
+			comparison_.Start({ a, b }, opt, wake_);
+		}
+	}
+
+	if (cmp_runs_.size() >= 2) {
+		const CompareRun& rb = cmp_runs_[1];
+		if (ImGui::BeginTable("##cmp", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+			ImGui::TableSetupColumn("Metric", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableSetupColumn("A");
+			ImGui::TableSetupColumn("B");
+			ImGui::TableSetupColumn("B - A");
+			ImGui::TableSetupColumn("95% paired");
+			ImGui::TableSetupColumn("95% unpaired");
+			ImGui::TableHeadersRow();
+			auto row = [](const char* name, const PairedStat& p, double scale, const char* fmt) {
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn(); ImGui::TextUnformatted(name);
+				ImGui::TableNextColumn(); ImGui::Text(fmt, p.a * scale);
+				ImGui::TableNextColumn(); ImGui::Text(fmt, p.b * scale);
+				ImGui::TableNextColumn(); ImGui::Text(fmt, p.diff * scale);
+				ImGui::TableNextColumn(); ImGui::Text(fmt, p.ci_paired * scale);
+				ImGui::TableNextColumn(); ImGui::TextDisabled(fmt, p.ci_independent * scale);
+			};
+			row("Risk of ruin (%)", rb.ruin, 100.0, "%.2f");
+			row("Hit target (%)", rb.hit_target, 100.0, "%.2f");
+			row("Expected end", rb.end, 1.0, "%.2f");
+			ImGui::EndTable();
+		}
+		ImGui::TextDisabled("Bets: A %.2f, B %.2f per spin (plan), A %.2f, B %.2f (average staked)", cmp_runs_[0].result.recommended_bet, rb.result.recommended_bet,
+			cmp_runs_[0].avg_bet, rb.avg_bet);
+#ifdef USE_IMPLOT
+		if (ImPlot::BeginPlot("##cmpbands", ImVec2(-1, -1), ImPlotFlags_NoBoxSelect | ImPlotFlags_NoMenus)) {
+			ImPlot::SetupAxes("Spin", "Bankroll", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+			for (const CompareRun& r : cmp_runs_) {
+				const PathBands& bd = r.bands;
+				std::string band = r.label + " p10-p90", mid = r.label + " p50";
+				ImPlot::PlotShaded(band.c_str(), bd.x.data(), bd.p10.data(), bd.p90.data(), bd.steps);
+				ImPlot::PlotLine(mid.c_str(), bd.x.data(), bd.p50.data(), bd.steps);
+			}
+			ImPlot::EndPlot();
+		}
+#endif
+	}
+	ImGui::End();
+}
+
+void SlotPlannerApp::DrawCampaign() {
+	ImGui::SetNextWindowSize({ 620, 560 }, ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Campaign", &show_campaign_)) { ImGui::End(); return; }
+	const Game& g = catalog_.Get(game_idx_);
+	ImGui::TextWrapped("The current plan on %s, session after session: each one re-plans from the bankroll it starts with. The campaign ends once the bankroll is below the quit line.", g.name.c_str());
+	ImGui::SliderInt("Sessions", &camp_in_.sessions, 1, 200);
+	ImGui::InputFloat("Deposit per session", &camp_in_.deposit, 1.0f, 10.0f, "%.2f");
+	ImGui::InputFloat("Withdraw above (0 = never)", &camp_in_.withdraw_above, 10.0f, 100.0f, "%.2f");
+	ImGui::InputFloat("Quit below (0 = 10% of start)", &camp_in_.quit_below, 1.0f, 10.0f, "%.2f");
+	camp_in_.deposit = std::max(0.f, camp_in_.deposit);
+	camp_in_.withdraw_above = std::max(0.f, camp_in_.withdraw_above);
+	camp_in_.quit_below = std::max(0.f, camp_in_.quit_below);
+
+	if (campaign_.Running()) {
+		ImGui::ProgressBar(float(campaign_.Done()) / std::max(1, campaign_.Total()), { -120, 0 });
+		ImGui::SameLine();
+		if (ImGui::Button("Cancel", { -1, 0 })) campaign_.Stop();
+	}
+	else {
+		if (campaign_.Finished() && !campaign_.Cancelled() && !campaign_.Result().x.empty()) {
+			camp_result_ = std::move(campaign_.Result());
+			campaign_.Result() = {};
+			char buf[128];
+			std::snprintf(buf, sizeof(buf), "%s, %d sessions in %.0f ms", campaign_.Played().name.c_str(), (int)camp_result_.x.size() - 1, campaign_.Ms());
+			camp_status_ = buf;
+		}
+		if (ImGui::Button("Run campaign", { -1, 0 })) campaign_.Start(g, input_, camp_in_, wake_);
+	}
+
+	const CampaignResult& r = camp_result_;
+	if (!r.x.empty()) {
+		ImGui::TextDisabled("%s", camp_status_.c_str());
+		ImGui::Text("After %d sessions: ruin %.1f%%, median %.2f, mean %.2f", (int)r.x.back(), r.ruin.back() * 100.f, r.p50.back(), r.mean.back());
+		ImGui::Text("Deposited %.2f, withdrawn %.2f (expected)", r.deposited.back(), r.withdrawn.back());
+		if (r.clamped > 0.001f) ImGui::TextDisabled("%.1f%% of a session's ends were past %.0f and counted as %.0f.", r.clamped * 100.f, r.grid_max, r.grid_max);
+#ifdef USE_IMPLOT
+		const int n = (int)r.x.size();
+		if (ImPlot::BeginPlot("##campbank", ImVec2(-1, 260), ImPlotFlags_NoBoxSelect | ImPlotFlags_NoMenus)) {
+			ImPlot::SetupAxes("Session", "Bankroll", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+			ImPlot::PlotShaded("p10-p90", r.x.data(), r.p10.data(), r.p90.data(), n);
+			ImPlot::PlotLine("p50", r.x.data(), r.p50.data(), n);
+			ImPlot::PlotLine("mean", r.x.data(), r.mean.data(), n);
+			ImPlot::EndPlot();
+		}
+		if (ImPlot::BeginPlot("##campruin", ImVec2(-1, -1), ImPlotFlags_NoBoxSelect | ImPlotFlags_NoMenus)) {
+			ImPlot::SetupAxes("Session", "P(ruined)", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_Lock);
+			ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 1.0, ImPlotCond_Always);
+			ImPlot::PlotLine("ruin", r.x.data(), r.ruin.data(), n);
+			ImPlot::EndPlot();
+		}
+#endif
+	}
+	ImGui::End();
+}
+
+void SlotPlannerApp::DrawStrategyEditor(const char* id, StrategyParams& p, const Game& g) {
+	ImGui::PushID(id);
+	const bool edge = KellyHasEdge(g);
+	if (ImGui::BeginCombo("Bet strategy", StrategyName(p.kind))) {
+		for (int k = 0; k < (int)BetStrategy::Count; ++k) {
+			const bool off = (BetStrategy)k == BetStrategy::Kelly && !edge;
+			if (ImGui::Selectable(off ? "Kelly (needs RTP above 1)" : StrategyName((BetStrategy)k), p.kind == (BetStrategy)k, off ? ImGuiSelectableFlags_Disabled : 0))
+				p.kind = (BetStrategy)k;
+		}
+		ImGui::EndCombo();
+	}
+	switch (p.kind) {
+	case BetStrategy::Proportional: {
+		float pct = p.fraction * 100.f;
+		if (ImGui::SliderFloat("Share of bankroll", &pct, 0.f, 5.f, pct > 0.f ? "%.2f%%" : "plan bet / start")) p.fraction = pct / 100.f;
+		break;
+	}
+	case BetStrategy::Kelly:
+		if (!edge) {
+			ImGui::TextWrapped("Kelly is meaningless here: with RTP below 1 the growth-optimal stake is zero, so it would only ever bet the minimum. Pick another strategy.");
+			break;
+		}
+		ImGui::SliderFloat("Kelly multiple", &p.kelly_scale, 0.1f, 1.f, "%.2f");
+		break;
+	case BetStrategy::Ramp:
+		ImGui::Checkbox("Raise after wins (off: after losses)", &p.ramp_on_win);
+		ImGui::SliderFloat("Step multiplier", &p.ramp_mult, 1.1f, 3.f, "x%.2f");
+		ImGui::SliderInt("Max steps", &p.ramp_steps, 1, 8);
+		break;
+	case BetStrategy::Martingale:
+		ImGui::SliderInt("Max doublings", &p.max_doublings, 1, 10);
+		break;
+	default:
+		break;
+	}
+	ImGui::PopID();
+}
+
+void SlotPlannerApp::DrawPerf() {
+	ImGui::SetNextWindowSize({ 520, 360 }, ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Perf", &show_perf_)) { ImGui::End(); return; }
+	if (!prof::kEnabled) {
+		ImGui::TextDisabled("Profiling compiled out (define SP_PROFILE).");
+		ImGui::End();
+		return;
+	}
+
+	uint64_t counters[prof::CounterCount];
+	prof::Snapshot(counters, perf_phases_);
+	for (int c = 0; c < prof::CounterCount; ++c)
+		ImGui::Text("%-16s %llu", prof::CounterName(c), (unsigned long long)counters[c]);
+
+	if (ImGui::Button("Reset")) prof::Reset();
+	ImGui::SameLine();
+	if (ImGui::Button("Start trace")) { prof::StartTrace(); perf_status_ = "Tracing..."; }
+	ImGui::SameLine();
+	if (ImGui::Button("Save trace"))
+		perf_status_ = prof::WriteTrace("trace.json") ? "Wrote trace.json" : "Cannot write trace.json";
+	ImGui::SameLine();
+	ImGui::TextDisabled("%s", perf_status_.c_str());
+
+	if (ImGui::BeginTable("##phases", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollY)) {
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Phase", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Calls");
+		ImGui::TableSetupColumn("Last ms");
+		ImGui::TableSetupColumn("Avg ms");
+		ImGui::TableSetupColumn("Max ms");
+		ImGui::TableHeadersRow();
+		for (const auto& p : perf_phases_) {
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(p.name.c_str());
+			ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)p.calls);
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", p.last_ms);
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", p.calls ? p.total_ms / p.calls : 0.0);
+			ImGui::TableNextColumn(); ImGui::Text("%.3f", p.max_ms);
+		}
+		ImGui::EndTable();
+	}
+	ImGui::End();
+}
+
+void SlotPlannerApp::DrawRanking() {
+	ImGui::SetNextWindowSize({ 640, 480 }, ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Catalog Ranking", &show_ranking_)) { ImGui::End(); return; }
+
+	if (ranking_.Running()) {
+		ImGui::ProgressBar(float(ranking_.Done()) / std::max(1, ranking_.Total()), { -120, 0 });
+		ImGui::SameLine();
+		if (ImGui::Button("Cancel", { -1, 0 })) { ranking_.Stop(); rank_status_ = "Cancelled"; }
+	}
+	else {
+		if (ranking_.Finished() && ranking_.Done() == ranking_.Total() && !ranking_.Rows().empty()) {
+			rank_rows_ = std::move(ranking_.Rows());
+			ranking_.Rows().clear();
+			rank_status_.clear();
+			rank_sort_dirty_ = true;
+		}
+		if (ImGui::Button("Rank all games")) {
+			std::vector<Game> all;
+			all.reserve(catalog_.Size());
+			for (int i = 0; i < catalog_.Size(); ++i) all.push_back(catalog_.Read(i));
+			ranking_.Start(std::move(all), input_, wake_);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Export CSV") && !rank_rows_.empty())
+			rank_status_ = WriteRankingCsv(rank_rows_, "ranking.csv") ? "Wrote ranking.csv" : "Cannot write ranking.csv";
+		ImGui::SameLine();
+		ImGui::TextDisabled("%s", rank_status_.c_str());
+	}
+
+	const ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY
+		| ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable;
+	if (ImGui::BeginTable("##rank", 5, flags)) {
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Game", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Hit target", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Ruin");
+		ImGui::TableSetupColumn("Expected end", ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("ms");
+		ImGui::TableHeadersRow();
+
+		if (ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs()) if (specs->SpecsDirty || rank_sort_dirty_) {
+			if (specs->SpecsCount) {
+				const ImGuiTableColumnSortSpecs& sp = specs->Specs[0];
+				auto key = [&](const RankRow& row) -> float {
+					switch (sp.ColumnIndex) {
+					case 1: return row.r.prob_hit_target;
+					case 2: return row.r.prob_ruin;
+					case 3: return row.r.expected_end;
+					case 4: return row.ms;
+					default: return 0.f;
+					}
+				};
+				bool asc = sp.SortDirection == ImGuiSortDirection_Ascending;
+				std::stable_sort(rank_rows_.begin(), rank_rows_.end(), [&](const RankRow& a, const RankRow& b) {
+					if (sp.ColumnIndex == 0) return asc ? a.name < b.name : b.name < a.name;
+					return asc ? key(a) < key(b) : key(b) < key(a);
+				});
+			}
+			specs->SpecsDirty = false;
+			rank_sort_dirty_ = false;
+		}
+
+		ImGuiListClipper clip;
+		clip.Begin((int)rank_rows_.size());
+		while (clip.Step()) for (int r = clip.DisplayStart; r < clip.DisplayEnd; ++r) {
+			const RankRow& row = rank_rows_[r];
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::PushID(r);
+			if (ImGui::Selectable(row.name.c_str(), row.game == game_idx_, ImGuiSelectableFlags_SpanAllColumns)) game_idx_ = row.game;
+			ImGui::PopID();
+			ImGui::TableNextColumn(); ImGui::Text("%.1f%%", row.r.prob_hit_target * 100.f);
+			ImGui::TableNextColumn(); ImGui::Text("%.1f%%", row.r.prob_ruin * 100.f);
+			ImGui::TableNextColumn(); ImGui::Text("%.2f", row.r.expected_end);
+			ImGui::TableNextColumn(); ImGui::Text("%.1f", row.ms);
+		}
+		ImGui::EndTable();
+	}
+	ImGui::End();
 }
 
 void SlotPlannerApp::DrawPlanSummary(const Game& g, const SessionInput& in, const SimResult& r) {
@@ -80,6 +506,23 @@ void SlotPlannerApp::DrawPlanSummary(const Game& g, const SessionInput& in, cons
 	ImGui::Text("Risk of busting before TP: %.1f%%", r.prob_ruin * 100.0f);
 	ImGui::Text("Chance to hit target before SL: %.1f%%", r.prob_hit_target * 100.0f);
 	ImGui::Text("Expected session end: %.2f", r.expected_end);
+	if (session_job_.Qmc()) {
+		RqmcEstimate e = session_job_.QmcEstimate();
+		ImGui::TextDisabled("Sobol x%d, std. error: ruin %.2f%%, target %.2f%%, end %.2f", SessionJob::kQmcReplicates, e.se_ruin * 100.f, e.se_hit * 100.f, e.se_end);
+	}
+	if (input_.strategy.kind != BetStrategy::Flat)
+		ImGui::TextDisabled("Instant estimate: flat bets only, so none for the %s strategy", StrategyName(input_.strategy.kind));
+	else if (preview_.jumps)
+		ImGui::TextDisabled("Instant estimate: ruin %.1f%%, end %.2f, ~%.0f spins (no target: bonus rounds and extras pay in lumps it can't model)",
+			preview_.prob_ruin * 100.f, preview_.expected_end, preview_.expected_spins);
+	else
+		ImGui::TextDisabled("Instant estimate: ruin %.1f%%, target %.1f%%, end %.2f, ~%.0f spins", preview_.prob_ruin * 100.f, preview_.prob_hit_target * 100.f,
+			preview_.expected_end, preview_.expected_spins);
+	if (deps_pending_) ImGui::TextDisabled("Inputs changed, rerunning once you stop editing...");
+	if (session_job_.Running()) {
+		char buf[64]; std::snprintf(buf, sizeof(buf), "%d / %d trials", session_job_.Done(), session_job_.Total());
+		ImGui::ProgressBar(float(session_job_.Done()) / std::max(1, session_job_.Total()), { -1, 0 }, buf);
+	}
 
 	if (!g.extras.empty()) {
 		ImGui::Separator(); ImGui::TextUnformatted("Extras included:");
@@ -100,28 +543,11 @@ void SlotPlannerApp::DrawPlanSummary(const Game& g, const SessionInput& in, cons
 	// Manual refresh
 	//if (ImGui::Button("Recompute bands")) { bands_dirty_ = true; }
 
-	// Re-sim only if needed
-	if (!bands_valid_ || bands_dirty_) {
-		bands_ = SimulatePathBands(g, input_);
-		bands_valid_ = true;
-		bands_dirty_ = false;
-
-		auto find_minmax = [](const std::vector<float>& v, float& mn, float& mx) {
-			for (float f : v) { mn = std::min(mn, f); mx = std::max(mx, f); }
-			};
-		bands_ymin_ = FLT_MAX; bands_ymax_ = -FLT_MAX;
-		find_minmax(bands_.p10, bands_ymin_, bands_ymax_);
-		find_minmax(bands_.p90, bands_ymin_, bands_ymax_);
-
-		float pad = std::max(1.0f, (bands_ymax_ - bands_ymin_) * 0.05f);
-		bands_ymin_ -= pad; bands_ymax_ += pad;
-	}
-
-	static std::vector<float> x;
-	x.resize(bands_.steps);
-	for (int i = 0; i < bands_.steps; ++i) x[i] = (float)i;
+	// bands are simulated by PumpJobs and refined in place
+	if (band_job_.Running()) ImGui::ProgressBar(band_job_.Progress(), { -1, 0 }, "Refining bands...");
+	if (!bands_valid_) { EndCard(); return; }
 
-	ImPlot::SetNextAxesLimits(0, (double)(bands_.steps - 1),
+	ImPlot::SetNextAxesLimits(0, (double)bands_.spins,
 		(double)bands_ymin_, (double)bands_ymax_,
 		ImGuiCond_Always);
 
@@ -134,14 +560,32 @@ void SlotPlannerApp::DrawPlanSummary(const Game& g, const SessionInput& in, cons
 		ImPlotAxisFlags_NoHighlight;
 
 	if (ImPlot::BeginPlot("Session Bands", ImVec2(-1, 260), plot_flags)) {
+		SP_PROFILE_SCOPE("Plot");
 		ImPlot::SetupAxes("Spin", "Bankroll", axis_flags, axis_flags);
 		// ImPlot::SetupAxes("","", axis_flags | ImPlotAxisFlags_NoTickLabels,
 		//                          axis_flags | ImPlotAxisFlags_NoTickLabels);
 
-		ImPlot::PlotShaded("p10–p90", x.data(), bands_.p10.data(), bands_.p90.data(), bands_.steps);
-		ImPlot::PlotLine("p50", x.data(), bands_.p50.data(), bands_.steps);
+		// vertex count follows the plot width, not the spin count
+		int px = (int)ImPlot::GetPlotSize().x;
+		if (!band_lod_.Matches(px, bands_version_)) BuildBandLod(bands_, px, bands_version_, band_lod_);
+
+		// same colors ImPlot would pick for the first two items
+		ImVec4 fill = ImPlot::GetColormapColor(0); fill.w *= ImPlot::GetStyle().FillAlpha;
+		BandPlotCache::Key key = BandPlotCache::MakeKey(band_lod_, ImGui::GetColorU32(fill), ImGui::GetColorU32(ImPlot::GetColormapColor(1)));
+		if (plot_cache_.Matches(key) || plot_cache_.Build(band_lod_, key, ImPlot::GetStyle().LineWeight)) {
+			ImPlot::PushPlotClipRect();
+			plot_cache_.Submit(ImPlot::GetPlotDrawList());
+			ImPlot::PopPlotClipRect();
+		}
+		else {
+			ImPlot::PlotShaded("p10–p90", band_lod_.x.data(), band_lod_.lo.data(), band_lod_.hi.data(), band_lod_.Count());
+			ImPlot::PlotLine("p50", band_lod_.mx.data(), band_lod_.mid.data(), band_lod_.MidCount());
+		}
 		ImPlot::EndPlot();
 	}
+	ImGui::TextDisabled("Bands: %s, %d points x %d/%d trials, median +/-%.2f (95%%)", BandEngineName(band_plan_.engine), band_plan_.points,
+		band_job_.Trials(), band_plan_.trials, band_job_.MedianError());
+	ImGui::TextDisabled("Plan: %.1f MB, ~%.0f ms%s", band_plan_.chosen.bytes / 1048576.0, band_plan_.chosen.ms, band_plan_.over_budget ? " (over budget)" : "");
 #else
 	ImGui::TextDisabled("ImPlot not compiled. Define USE_IMPLOT to enable charts.");
 #endif
@@ -151,18 +595,36 @@ void SlotPlannerApp::DrawPlanSummary(const Game& g, const SessionInput& in, cons
 
 void SlotPlannerApp::DrawLeftPane() {
 	BeginCard("Setup");
-	auto& g = games_[game_idx_];
+	auto& g = catalog_.Get(game_idx_);
 
-	if (ImGui::BeginCombo("Game", g.name.c_str())) {
-		for (int i = 0; i < (int)games_.size(); ++i) { bool sel = (i == game_idx_); if (ImGui::Selectable(games_[i].name.c_str(), sel)) game_idx_ = i; if (sel) ImGui::SetItemDefaultFocus(); }
+	if (ImGui::BeginCombo("Game", g.name.c_str(), ImGuiComboFlags_HeightLarge)) {
+		if (ImGui::IsWindowAppearing()) ImGui::SetKeyboardFocusHere();
+		if (ImGui::InputTextWithHint("##filter", "Search", game_filter_, IM_ARRAYSIZE(game_filter_)) || game_matches_dirty_) {
+			catalog_.Search(game_filter_, game_matches_);
+			game_matches_dirty_ = false;
+		}
+		// only the visible rows are submitted, names come straight from the catalog pool
+		ImGuiListClipper clip;
+		clip.Begin((int)game_matches_.size());
+		while (clip.Step()) for (int r = clip.DisplayStart; r < clip.DisplayEnd; ++r) {
+			int i = game_matches_[r];
+			std::string_view name = catalog_.Name(i);
+			bool sel = (i == game_idx_);
+			ImGui::PushID(i);
+			float x0 = ImGui::GetCursorPosX();
+			if (ImGui::Selectable("##game", sel)) game_idx_ = i;
+			if (sel) ImGui::SetItemDefaultFocus();
+			ImGui::SameLine(x0);
+			ImGui::TextUnformatted(name.data(), name.data() + name.size());
+			ImGui::PopID();
+		}
 		ImGui::EndCombo();
 	}
 
 	ImGui::TextDisabled("Base RTP: %.2f%% | Hit: %.1f%% | Vol: %.2f", g.rtp * 100.f, g.hit_rate * 100.f, g.volatility);
+	if (eff_cost_ > 1.f) ImGui::TextDisabled("With extras: RTP %.2f%% | Cost %.2fx", eff_rtp_ * 100.f, eff_cost_);
 	ImGui::Separator();
 
-	bool changed = false;
-
 	ImGui::InputFloat("Starting balance", &input_.start_bankroll, 1.0f, 10.0f, "%.2f");
 	if (input_.start_bankroll < 1.0f) input_.start_bankroll = 1.0f;
 
@@ -175,13 +637,15 @@ void SlotPlannerApp::DrawLeftPane() {
 	ImGui::RadioButton("Balanced", &r, (int)RiskProfile::Balanced); ImGui::SameLine();
 	ImGui::RadioButton("Aggressive", &r, (int)RiskProfile::Aggressive); input_.risk = (RiskProfile)r;
 
-	if (changed) bands_dirty_ = true;
-
 	ImGui::Separator();
 
 	if (!g.extras.empty()) {
 		ImGui::TextUnformatted("Extras (side bets)");
-		for (auto& e : g.extras) { ImGui::PushID(&e); ImGui::Checkbox(e.name.c_str(), &e.enabled); ImGui::SameLine(); ImGui::TextDisabled("RTP %.1f%%, cost +%.0f%%", e.rtp * 100.f, e.cost_mult * 100.f); ImGui::PopID(); }
+		for (auto& e : g.extras) {
+			ImGui::PushID(&e); ImGui::Checkbox(e.name.c_str(), &e.enabled); ImGui::SameLine();
+			ImGui::TextDisabled("RTP %.1f%%, cost +%.0f%%, feature 1 in %.0f spins", e.rtp * 100.f, e.cost_mult * 100.f, 1.f / ExtraHitRate(e));
+			ImGui::PopID();
+		}
 	}
 
 	ImGui::Separator();
@@ -191,13 +655,13 @@ void SlotPlannerApp::DrawLeftPane() {
 
 	ImGui::Separator();
 
-	if (ImGui::Button("Run Simulation", { -1, 0 })) { result_ = SimulateSession(g, input_); has_result_ = true; bands_dirty_ = true; }
+	if (ImGui::Button("Run Simulation", { -1, 0 })) { has_result_ = true; dep_result_.Invalidate(); dep_bands_.Invalidate(); UpdateDeps(true); }
 
 	EndCard();
 }
 
 void SlotPlannerApp::DrawRightPane() {
-	auto& g = games_[game_idx_];
+	auto& g = catalog_.Get(game_idx_);
 	if (has_result_) DrawPlanSummary(g, input_, result_);
 	else { BeginCard("Session Plan Summary"); ImGui::TextWrapped("Set bankroll, pick a game, and Run Simulation for bet sizing, stop-loss, and profit target."); EndCard(); }
 
@@ -206,13 +670,33 @@ void SlotPlannerApp::DrawRightPane() {
 	BeginCard("Advanced");
 	ImGui::TextDisabled("Tuning & what-if analysis");
 	ImGui::SliderInt("Trials", &input_.trials, 500, 20000);
+	const char* engines[] = { "Pseudo-random", "Quasi-random (scrambled Sobol)", "Exact cents (fixed-point)" };
+	int engine = (int)engine_;
+	if (ImGui::Combo("Trial engine", &engine, engines, IM_ARRAYSIZE(engines))) engine_ = (SessionEngine)engine;
+	if (engine_ == SessionEngine::Fixed && has_result_) {
+		const CentRounding cr = CentRoundingFor(g, result_.recommended_bet);
+		if (cr.Distorted())
+			ImGui::TextWrapped("Whole cents: a %.3f bet is placed as %.2f and cent-floored payouts cost %.1f%% RTP, so this plan plays differently from the float engine.",
+				result_.recommended_bet, result_.recommended_bet * cr.stake_ratio, cr.rtp_loss * 100.f);
+	}
+	const char* tiers[] = { "Exact (std::)", "Fast (float-accurate)", "Faster (~1e-4)" };
+	int tier = (int)input_.payout_math;
+	if (ImGui::Combo("Payout math", &tier, tiers, IM_ARRAYSIZE(tiers))) input_.payout_math = (MathTier)tier;
+	DrawStrategyEditor("plan", input_.strategy, g);
 	ImGui::SliderInt("Max spins cap (if no time)", &input_.max_spins_cap, 100, 5000);
+	ImGui::SliderInt("Band points", &band_res_.points, 0, 2000, band_res_.points <= 0 ? "every spin" : "%d");
+	ImGui::SliderInt("Memory budget (MB)", &band_budget_mb_, 8, 1024);
+	ImGui::Checkbox("Log-spaced bands", &band_res_.log_spaced);
 
 	if (ImGui::CollapsingHeader("Edit current game stats")) {
 		ImGui::InputFloat("Base RTP", &g.rtp, 0.001f, 0.01f, "%.3f");
 		ImGui::SliderFloat("Hit rate", &g.hit_rate, 0.02f, 0.60f, "%.2f");
 		ImGui::SliderFloat("Volatility", &g.volatility, 0.10f, 0.95f, "%.2f");
 		ImGui::InputFloat("Max win (x)", &g.max_win_x, 10.0f, 100.0f, "%.0f");
+		float every = g.bonus_rate > 0.f ? 1.f / g.bonus_rate : 0.f;
+		if (ImGui::InputFloat("Bonus round every (spins, 0 = none)", &every, 10.f, 100.f, "%.0f")) g.bonus_rate = every >= 1.f ? 1.f / every : 0.f;
+		ImGui::SliderFloat("Share of RTP from bonus", &g.bonus_share, 0.f, 0.8f, "%.2f");
+		ImGui::SliderInt("Free spins per round", &g.bonus_spins, 1, 50);
 	}
 
 	if (ImGui::CollapsingHeader("Add custom extra bet")) {
@@ -220,7 +704,7 @@ void SlotPlannerApp::DrawRightPane() {
 		ImGui::SliderFloat("RTP", &custom_extra_rtp_, 0.80f, 0.99f, "%.2f");
 		ImGui::SliderFloat("Cost (+x base)", &custom_extra_cost_, 0.05f, 100.0f, "%.2f");
 		if (ImGui::Button("Add to game")) {
-			if (custom_extra_name_[0]) { games_[game_idx_].extras.push_back({ custom_extra_name_, custom_extra_rtp_, custom_extra_cost_, true }); custom_extra_name_[0] = '\0'; }
+			if (custom_extra_name_[0]) { g.extras.push_back({ custom_extra_name_, custom_extra_rtp_, custom_extra_cost_, true }); custom_extra_name_[0] = '\0'; }
 		}
 	}
 
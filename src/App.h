@@ -1,32 +1,104 @@
 #pragma once
 #include "Models.h"
 #include "Simulator.h"
+#include "Planner.h"
+#include "BandLod.h"
+#include "PlotCache.h"
+#include "Catalog.h"
+#include "Ranking.h"
+#include "SimJob.h"
+#include "Deps.h"
+#include "Compare.h"
+#include "Campaign.h"
+#include "Diffusion.h"
 #include "Style.h"
+#include "Profiler.h"
 #include <imgui.h>
 #include <string>
 #include <vector>
+#include <functional>
 
 class SlotPlannerApp {
+    friend class HeadlessBench; // drives private state for scripted UI benchmarks
 public:
     SlotPlannerApp();
     void Draw();
+    bool OpenCatalog(const std::string& path);
+    bool Busy() const { return ranking_.Running() || campaign_.Running() || comparison_.Running() || deps_pending_; } // work worth redrawing for
+    bool Simulating() const { return session_job_.Running() || band_job_.Running() || (has_result_ && bands_dirty_); } // sliced work left for the next frame
+    void SetWakeCallback(std::function<void()> wake) { wake_ = std::move(wake); }
 private:
-    std::vector<Game> games_;
+    std::function<void()> wake_;   // called from worker threads when results land
+    GameCatalog catalog_;
     int game_idx_ = 0;
+    char game_filter_[64] = "";
+    std::vector<int> game_matches_;  // catalog indices shown in the Game combo
+    bool game_matches_dirty_ = true;
+    bool open_catalog_ = false;
+    char catalog_path_[260] = "";
+    std::string catalog_status_;
+
+    RankingRun ranking_;
+    std::vector<RankRow> rank_rows_;
+    bool show_ranking_ = false;
+    bool rank_sort_dirty_ = false;
+    std::string rank_status_;
+    bool show_compare_ = false;
+    int cmp_risk_b_ = (int)RiskProfile::Aggressive;
+    float cmp_bankroll_b_ = 0.f;      // 0: same as A
+    std::vector<char> cmp_extras_b_;  // enabled flags for B, per extra of the current game
+    StrategyParams cmp_strategy_b_;  // A runs input_.strategy
+    int cmp_trials_ = 2000;
+    std::vector<CompareRun> cmp_runs_;
+    ComparisonRun comparison_;
+    bool show_campaign_ = false;
+    CampaignInput camp_in_{};
+    CampaignRun campaign_;
+    CampaignResult camp_result_{};
+    std::string camp_status_;
+    bool show_perf_ = false;
+    std::vector<prof::PhaseStats> perf_phases_;
+    std::string perf_status_;
     SessionInput input_{};
     SimResult result_{};
     bool has_result_ = false;
+    DepNode dep_game_, dep_plan_, dep_result_, dep_bands_; // keys the derived values were built from
+    Debouncer debounce_;
+    bool deps_pending_ = false;  // stale simulation waiting for edits to settle
+    SessionEngine engine_ = SessionEngine::Random; // how the summary's trials are run
+    float eff_rtp_ = 1.f, eff_cost_ = 1.f;
+    DiffusionEstimate preview_{}; // closed-form, refreshed with the plan node
+    ExtraProcess preview_extras_;  // feature tables the preview reads, rebuilt once game edits settle
+    DepNode dep_extras_;
+    SessionJob session_job_;     // result_ fills in as trials complete
+    BandJob band_job_;           // refines bands_ as trials accumulate
+    int band_refreshes_seen_ = 0;
+    static constexpr double kFrameBudgetMs = 8.0; // simulation time per frame, half a 60 Hz frame
     bool show_advanced_ = false;
     char custom_extra_name_[64] = "";
     float custom_extra_rtp_ = 0.95f;
     float custom_extra_cost_ = 0.50f;
 
     PathBands bands_{};
+    BandResolution band_res_{};
+    PathArena band_arena_;       // snapshot storage, reused across refreshes
+    BandPlan band_plan_{};
+    int band_budget_mb_ = 64;
     bool bands_valid_ = false;   // cached result present?
     bool bands_dirty_ = true;    // need recompute?
     float bands_ymin_ = 0.f, bands_ymax_ = 0.f; // for axis lock
+    uint64_t bands_version_ = 0; // bumped on every recompute
+    BandLod band_lod_{};         // per-pixel reduction of bands_
+    BandPlotCache plot_cache_{}; // tessellated band_lod_, reused while nothing changes
 
+    void UpdateDeps(bool force = false);
+    void PumpJobs(double budget_ms);
     void DrawLeftPane();
     void DrawRightPane();
     void DrawPlanSummary(const Game& g, const SessionInput& in, const SimResult& r);
+    void DrawRanking();
+    void DrawCompare();
+    void DrawCampaign();
+    void DrawStrategyEditor(const char* id, StrategyParams& p, const Game& g);
+    void DrawPerf();
 };
\ No newline at end of file
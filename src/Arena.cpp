@@ -0,0 +1,61 @@
+#include "Arena.h"
+#include "Profiler.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+static const size_t kHugePage = size_t(2) << 20;
+
+static size_t RoundUp(size_t n, size_t a) { return (n + a - 1) / a * a; }
+
+#ifdef _WIN32
+static void* MapPages(size_t& bytes, bool& huge) {
+    // large pages need SeLockMemoryPrivilege; fall back quietly without it
+    size_t large = GetLargePageMinimum();
+    if (large && bytes >= large) {
+        size_t sz = RoundUp(bytes, large);
+        if (void* p = VirtualAlloc(nullptr, sz, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE)) { bytes = sz; huge = true; return p; }
+    }
+    huge = false;
+    return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+static void UnmapPages(void* p, size_t) { VirtualFree(p, 0, MEM_RELEASE); }
+#else
+static void* MapPages(size_t& bytes, bool& huge) {
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return nullptr;
+    huge = false;
+#ifdef MADV_HUGEPAGE
+    if (bytes >= kHugePage) huge = madvise(p, bytes, MADV_HUGEPAGE) == 0;
+#endif
+    return p;
+}
+static void UnmapPages(void* p, size_t bytes) { munmap(p, bytes); }
+#endif
+
+PathArena::~PathArena() { Release(); }
+
+float* PathArena::Acquire(size_t count) {
+    if (count <= cap_) return data_;
+    Release();
+    // headroom so small slider moves don't remap
+    size_t bytes = RoundUp(count * sizeof(float) + count * sizeof(float) / 4, kHugePage);
+    void* p = MapPages(bytes, huge_);
+    if (!p) return nullptr;
+    data_ = static_cast<float*>(p);
+    bytes_ = bytes;
+    cap_ = bytes / sizeof(float);
+    ++allocs_;
+    SP_COUNT(BytesAllocated, bytes);
+    return data_;
+}
+
+void PathArena::Release() {
+    if (data_) UnmapPages(data_, bytes_);
+    data_ = nullptr; cap_ = 0; bytes_ = 0; huge_ = false;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+
+// One contiguous float buffer for path snapshots, reused across band runs.
+// Grows only when a run needs more than it already holds; tries huge pages first.
+class PathArena {
+public:
+    PathArena() = default;
+    ~PathArena();
+    PathArena(const PathArena&) = delete;
+    PathArena& operator=(const PathArena&) = delete;
+
+    float* Acquire(size_t count); // contents undefined
+    void Release();
+
+    size_t Capacity() const { return cap_; }
+    size_t Bytes() const { return bytes_; }
+    bool HugePages() const { return huge_; }
+    int Allocations() const { return allocs_; }
+
+private:
+    float* data_ = nullptr;
+    size_t cap_ = 0;    // floats
+    size_t bytes_ = 0;  // mapped size
+    bool huge_ = false;
+    int allocs_ = 0;
+};
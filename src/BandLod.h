@@ -0,0 +1,59 @@
+#pragma once
+#include "Simulator.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Band series reduced to a couple of points per pixel column. Each bucket keeps the
+// lowest p10 and highest p90 (so the shaded envelope never shrinks) and the p50 min/max
+// in index order (so spikes in the median survive). Rebuilt only when the data version
+// or the pixel width changes.
+struct BandLod {
+	std::vector<float> x, lo, hi;   // shaded p10..p90
+	std::vector<float> mx, mid;     // p50 line
+	int pixels = 0;
+	uint64_t version = 0;
+
+	bool Matches(int px, uint64_t ver) const { return px == pixels && ver == version && !x.empty(); }
+	int Count() const { return (int)x.size(); }
+	int MidCount() const { return (int)mx.size(); }
+};
+
+inline void BuildBandLod(const PathBands& b, int pixels, uint64_t version, BandLod& out) {
+	out.pixels = pixels; out.version = version;
+	out.x.clear(); out.lo.clear(); out.hi.clear(); out.mx.clear(); out.mid.clear();
+	const int n = b.steps;
+	if (n <= 0) return;
+
+	const int buckets = std::max(1, pixels);
+	if (n <= 2 * buckets) {
+		out.x = b.x; out.lo = b.p10; out.hi = b.p90;
+		out.mx = b.x; out.mid = b.p50;
+		return;
+	}
+	out.x.reserve(2 * buckets); out.lo.reserve(2 * buckets); out.hi.reserve(2 * buckets);
+	out.mx.reserve(2 * buckets); out.mid.reserve(2 * buckets);
+
+	// buckets split the x range evenly, so log-spaced bands stay pixel-accurate too
+	const float x0 = b.x.front(), span = std::max(1e-6f, b.x.back() - x0);
+	int i = 0;
+	for (int k = 0; k < buckets && i < n; ++k) {
+		float edge = k + 1 == buckets ? b.x.back() : x0 + span * float(k + 1) / buckets;
+		int first = i;
+		float lo = b.p10[i], hi = b.p90[i];
+		int imin = i, imax = i;
+		for (; i < n && (b.x[i] <= edge || i == first); ++i) {
+			lo = std::min(lo, b.p10[i]); hi = std::max(hi, b.p90[i]);
+			if (b.p50[i] < b.p50[imin]) imin = i;
+			if (b.p50[i] > b.p50[imax]) imax = i;
+		}
+		int last = i - 1;
+		out.x.push_back(b.x[first]); out.lo.push_back(lo); out.hi.push_back(hi);
+		if (last != first) { out.x.push_back(b.x[last]); out.lo.push_back(lo); out.hi.push_back(hi); }
+		int a = std::min(imin, imax), c = std::max(imin, imax);
+		out.mx.push_back(b.x[a]); out.mid.push_back(b.p50[a]);
+		if (c != a) { out.mx.push_back(b.x[c]); out.mid.push_back(b.p50[c]); }
+	}
+	// keep the exact terminal values
+	if (out.mx.back() != b.x.back()) { out.mx.push_back(b.x.back()); out.mid.push_back(b.p50.back()); }
+}
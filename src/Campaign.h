@@ -0,0 +1,246 @@
+#pragma once
+#include "Compare.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// A campaign chains sessions: each one is planned from the bankroll it starts with (bet,
+// stop-loss, take-profit as SimulateSession would pick them), a deposit goes in before it,
+// anything above withdraw_above comes out after it, and the campaign is over once the
+// bankroll is below quit_below at the start of a session.
+//
+// Sessions only depend on their starting bankroll, so SimulateCampaign estimates a
+// one-session transition kernel once: for every point of a bankroll grid it runs `trials`
+// sessions from that bankroll and splits each end bankroll between its two neighbouring
+// grid points, which keeps the mean. The distribution is then carried from session to
+// session as a histogram on that grid, bins x bins work per session however long the
+// horizon. The grid is linear up to quit_below, which is a grid point of its own so ruin
+// never leaks across it, then geometric: bonus rounds put real mass at 100x the deposit
+// and a linear grid would need thousands of bins to keep both ends.
+
+struct CampaignInput {
+	int sessions = 30;
+	float deposit = 0.f;        // added before each session played
+	float withdraw_above = 0.f; // taken out after each session; 0: never
+	float quit_below = 0.f;     // global ruin; 0: 10% of the starting bankroll
+	int bins = 160;
+	int trials = 400;           // sessions simulated per grid point for the kernel
+	uint64_t seed = 0x5107;
+	int threads = 0;
+};
+
+struct CampaignResult {
+	std::vector<float> x;                    // sessions played, 0..N
+	std::vector<float> ruin;                 // P(campaign over by then)
+	std::vector<float> mean, p10, p50, p90;  // bankroll, ruined campaigns at what they kept
+	std::vector<float> withdrawn, deposited; // expected running totals
+	float grid_max = 0.f;                    // bankroll grid top; session ends past it are clamped
+	float clamped = 0.f;                     // largest share of a session's ends clamped
+};
+
+inline float CampaignQuitBelow(const SessionInput& in, const CampaignInput& c) { return c.quit_below > 0.f ? c.quit_below : 0.1f * in.start_bankroll; }
+
+// the bankroll after one session from `start` on trial stream t, before the withdrawal
+inline double CampaignSession(const Game& g, SessionInput in, double start, int t, uint64_t seed) {
+	static const std::vector<int> no_snapshots;
+	in.start_bankroll = float(start);
+	const SessionSetup su = PrepareSession(g, in);
+	return RunCrnTrial(g, in, su, TrialRng(seed, t), no_snapshots, [](int, float) {}).end;
+}
+
+namespace campaign {
+struct Grid {
+	std::vector<double> v; // ascending; v[quit_at] == quit_below
+	int quit_at = 0;       // points below it are ruined campaigns
+
+	Grid(int n, double quit, double unit, double top) {
+		quit_at = std::max(4, n / 16);
+		const int geo = std::max(4, n - quit_at - 1);
+		const double k = std::log1p(std::max(0.0, top - quit) / unit) / geo;
+		for (int i = 0; i < quit_at; ++i) v.push_back(quit * i / quit_at);
+		for (int j = 0; j <= geo; ++j) v.push_back(quit + unit * std::expm1(k * j));
+		v.back() = top;
+	}
+	int Size() const { return (int)v.size(); }
+
+	// mean-preserving split of value x between the two nearest points, except that a
+	// ruined bankroll stays below quit; false when x was past the top and clamped
+	bool Deposit(std::vector<double>& p, double x, double w) const {
+		if (x >= v.back()) { p.back() += w; return x == v.back(); }
+		const int i = std::max(0, int(std::upper_bound(v.begin(), v.end(), x) - v.begin()) - 1);
+		if (i + 1 == quit_at) { p[i] += w; return true; }
+		const double frac = (x - v[i]) / (v[i + 1] - v[i]);
+		p[i] += w * (1.0 - frac);
+		p[i + 1] += w * frac;
+		return true;
+	}
+
+	// mass at point i read as spread evenly between the midpoints to its neighbours
+	float Quantile(const std::vector<double>& p, double q) const {
+		double acc = 0.0;
+		for (int i = 0; i < Size(); ++i) {
+			if (acc + p[i] >= q && p[i] > 0.0) {
+				const double lo = i > 0 ? 0.5 * (v[i - 1] + v[i]) : v[0];
+				const double hi = i + 1 < Size() ? 0.5 * (v[i] + v[i + 1]) : v[i];
+				return float(lo + (hi - lo) * (q - acc) / p[i]);
+			}
+			acc += p[i];
+		}
+		return float(v.back());
+	}
+};
+}
+
+// done counts finished kernel rows (CampaignKernelRows of them); a cancelled run returns
+// an empty result
+inline int CampaignKernelRows(const CampaignInput& c) { return std::max(16, c.bins); }
+
+inline CampaignResult SimulateCampaign(const Game& g, const SessionInput& in, const CampaignInput& c,
+	std::atomic<int>* done = nullptr, const std::atomic<bool>* cancel = nullptr) {
+	SP_PROFILE_SCOPE("SimulateCampaign");
+	const int trials = std::max(10, c.trials), sessions = std::max(1, c.sessions);
+	const double quit = std::max(1e-3f, CampaignQuitBelow(in, c));
+	const double stake = double(in.start_bankroll) + c.deposit;
+	// nothing stays above withdraw_above; otherwise room for a run of big bonus rounds
+	const double top = c.withdraw_above > 0.f ? std::max<double>(c.withdraw_above, 2.0 * quit) : std::max(100.0 * stake, 2.0 * quit);
+	const campaign::Grid grid(CampaignKernelRows(c), quit, std::max(0.05 * stake, 0.1 * quit), top);
+	const int n = grid.Size();
+
+	// kernel rows: next-session distribution, expected withdrawal and clamped share from
+	// grid point i; every row on its own streams so their sampling errors average out
+	std::vector<double> kernel(size_t(n) * n, 0.0), withdraw(n, 0.0), clamped(n, 0.0);
+	TaskPool::ParallelFor(n, [&](int i) {
+		double* row = &kernel[size_t(i) * n];
+		if (cancel && *cancel) return;
+		if (i < grid.quit_at) { row[i] = 1.0; if (done) ++*done; return; }
+		std::vector<double> p(n, 0.0);
+		const double w = 1.0 / trials;
+		const uint64_t seed = hashing::Mix(c.seed, uint64_t(i));
+		for (int t = 0; t < trials; ++t) {
+			double end = CampaignSession(g, in, grid.v[i] + c.deposit, t, seed);
+			if (c.withdraw_above > 0.f && end > c.withdraw_above) { withdraw[i] += w * (end - c.withdraw_above); end = c.withdraw_above; }
+			if (!grid.Deposit(p, end, w)) clamped[i] += w;
+		}
+		std::copy(p.begin(), p.end(), row);
+		if (done) ++*done;
+	}, c.threads);
+	if (cancel && *cancel) return {};
+
+	CampaignResult r;
+	r.grid_max = float(top);
+	std::vector<double> p(n, 0.0), next(n);
+	grid.Deposit(p, in.start_bankroll, 1.0);
+	double withdrawn = 0.0, deposited = 0.0;
+	for (int s = 0; s <= sessions; ++s) {
+		double ruin = 0.0, mean = 0.0;
+		for (int i = 0; i < n; ++i) { mean += p[i] * grid.v[i]; if (i < grid.quit_at) ruin += p[i]; }
+		r.x.push_back(float(s));
+		r.ruin.push_back(float(ruin));
+		r.mean.push_back(float(mean));
+		r.p10.push_back(grid.Quantile(p, 0.10));
+		r.p50.push_back(grid.Quantile(p, 0.50));
+		r.p90.push_back(grid.Quantile(p, 0.90));
+		r.withdrawn.push_back(float(withdrawn));
+		r.deposited.push_back(float(deposited));
+		if (s == sessions) break;
+
+		std::fill(next.begin(), next.end(), 0.0);
+		double over = 0.0;
+		for (int i = 0; i < n; ++i) {
+			if (p[i] == 0.0) continue;
+			if (i >= grid.quit_at) { withdrawn += p[i] * withdraw[i]; deposited += p[i] * c.deposit; over += p[i] * clamped[i]; }
+			const double* row = &kernel[size_t(i) * n];
+			for (int j = 0; j < n; ++j) next[j] += p[i] * row[j];
+		}
+		r.clamped = std::max(r.clamped, float(over));
+		p.swap(next);
+	}
+	return r;
+}
+
+// Background campaign for the UI, like RankingRun: the worker owns the result until
+// Finished().
+class CampaignRun {
+public:
+	~CampaignRun() { Stop(); }
+
+	void Start(Game g, const SessionInput& in, const CampaignInput& c, std::function<void()> on_done = {}) {
+		Stop();
+		game_ = std::move(g);
+		total_ = CampaignKernelRows(c);
+		done_ = 0; cancel_ = false; finished_ = false;
+		worker_ = std::thread([this, in, c, on_done] {
+			auto t0 = std::chrono::steady_clock::now();
+			result_ = SimulateCampaign(game_, in, c, &done_, &cancel_);
+			ms_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+			finished_ = true;
+			if (on_done) on_done();
+		});
+	}
+	void Stop() {
+		cancel_ = true;
+		if (worker_.joinable()) worker_.join();
+	}
+	bool Running() const { return worker_.joinable() && !finished_; }
+	bool Finished() const { return finished_; }
+	bool Cancelled() const { return cancel_; }
+	int Done() const { return done_; }
+	int Total() const { return total_; }
+	float Ms() const { return ms_; }
+	const Game& Played() const { return game_; }
+	CampaignResult& Result() { return result_; }
+
+private:
+	Game game_;
+	CampaignResult result_;
+	std::thread worker_;
+	std::atomic<int> done_{ 0 };
+	std::atomic<bool> cancel_{ false }, finished_{ false };
+	int total_ = 0;
+	float ms_ = 0.f;
+};
+
+// Reference: every path chained session by session from its exact bankroll. O(paths x
+// sessions) sessions, for checking the kernel.
+inline CampaignResult SimulateCampaignPaths(const Game& g, const SessionInput& in, const CampaignInput& c, int paths) {
+	SP_PROFILE_SCOPE("SimulateCampaignPaths");
+	const int sessions = std::max(1, c.sessions);
+	const double quit = CampaignQuitBelow(in, c);
+	std::vector<float> bank(size_t(paths) * (sessions + 1));
+	std::vector<double> withdrawn(size_t(paths) * (sessions + 1), 0.0), deposited(withdrawn.size(), 0.0);
+	TaskPool::ParallelFor(paths, [&](int t) {
+		double b = in.start_bankroll, w = 0.0, d = 0.0;
+		for (int s = 0; s <= sessions; ++s) {
+			const size_t k = size_t(t) * (sessions + 1) + s;
+			bank[k] = float(b); withdrawn[k] = w; deposited[k] = d;
+			if (s == sessions || b < quit) continue;
+			b += c.deposit; d += c.deposit;
+			b = CampaignSession(g, in, b, t, c.seed ^ (uint64_t(s + 1) << 40));
+			if (c.withdraw_above > 0.f && b > c.withdraw_above) { w += b - c.withdraw_above; b = c.withdraw_above; }
+		}
+	}, c.threads);
+
+	CampaignResult r;
+	std::vector<float> col(paths);
+	for (int s = 0; s <= sessions; ++s) {
+		double ruin = 0.0, mean = 0.0, w = 0.0, d = 0.0;
+		for (int t = 0; t < paths; ++t) {
+			const size_t k = size_t(t) * (sessions + 1) + s;
+			col[t] = bank[k]; mean += bank[k]; w += withdrawn[k]; d += deposited[k]; ruin += bank[k] < quit;
+		}
+		std::sort(col.begin(), col.end());
+		r.x.push_back(float(s));
+		r.ruin.push_back(float(ruin / paths));
+		r.mean.push_back(float(mean / paths));
+		r.p10.push_back(PercentileSorted(col.data(), paths, 10));
+		r.p50.push_back(PercentileSorted(col.data(), paths, 50));
+		r.p90.push_back(PercentileSorted(col.data(), paths, 90));
+		r.withdrawn.push_back(float(w / paths));
+		r.deposited.push_back(float(d / paths));
+	}
+	return r;
+}
@@ -0,0 +1,320 @@
+#include "Catalog.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace catalog;
+
+class MappedFile {
+public:
+	~MappedFile() { Close(); }
+	bool Open(const std::string& path) {
+#ifdef _WIN32
+		file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file_ == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER sz; if (!GetFileSizeEx(file_, &sz) || sz.QuadPart == 0) return false;
+		size_ = (size_t)sz.QuadPart;
+		map_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!map_) return false;
+		data_ = (const char*)MapViewOfFile(map_, FILE_MAP_READ, 0, 0, 0);
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st; if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+		size_ = (size_t)st.st_size;
+		void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		data_ = p == MAP_FAILED ? nullptr : (const char*)p;
+#endif
+		return data_ != nullptr;
+	}
+	void Close() {
+#ifdef _WIN32
+		if (data_) UnmapViewOfFile(data_);
+		if (map_) CloseHandle(map_);
+		if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+		map_ = nullptr; file_ = INVALID_HANDLE_VALUE;
+#else
+		if (data_) munmap((void*)data_, size_);
+#endif
+		data_ = nullptr; size_ = 0;
+	}
+	const char* Data() const { return data_; }
+	size_t Size() const { return size_; }
+private:
+	const char* data_ = nullptr;
+	size_t size_ = 0;
+#ifdef _WIN32
+	HANDLE file_ = INVALID_HANDLE_VALUE, map_ = nullptr;
+#endif
+};
+
+namespace {
+// Builds a catalog image; repeated names ("Xbet", "Bonus Buy (100x)") are stored once.
+struct ImageBuilder {
+	std::vector<GameRec> games;
+	std::vector<ExtraRec> extras;
+	std::string pool;
+	std::unordered_map<std::string, uint32_t> interned;
+
+	uint32_t Intern(std::string_view s) {
+		auto it = interned.find(std::string(s));
+		if (it != interned.end()) return it->second;
+		uint32_t off = (uint32_t)pool.size();
+		pool.append(s.data(), s.size());
+		interned.emplace(std::string(s), off);
+		return off;
+	}
+	void AddGame(std::string_view name, float rtp, float hit, float vol, float max_x, float bonus_rate = 0.f, float bonus_share = 0.f, int bonus_spins = 10) {
+		games.push_back({ Intern(name), (uint32_t)name.size(), rtp, hit, vol, max_x, (uint32_t)extras.size(), 0, bonus_rate, bonus_share, (uint32_t)std::clamp(bonus_spins, 1, int(kMaxBonusSpins)) });
+	}
+	void AddExtra(std::string_view name, float rtp, float cost, float hit = 0.f, float vol = -1.f) {
+		extras.push_back({ Intern(name), (uint32_t)name.size(), rtp, cost, hit, vol });
+		games.back().extra_count++;
+	}
+	std::vector<char> Finish() const {
+		Header h;
+		h.game_count = (uint32_t)games.size();
+		h.extra_count = (uint32_t)extras.size();
+		h.pool_bytes = (uint32_t)pool.size();
+		h.games_off = sizeof(Header);
+		h.extras_off = h.games_off + h.game_count * sizeof(GameRec);
+		h.pool_off = h.extras_off + h.extra_count * sizeof(ExtraRec);
+		std::vector<char> img(h.pool_off + h.pool_bytes);
+		std::memcpy(img.data(), &h, sizeof(h));
+		if (!games.empty()) std::memcpy(img.data() + h.games_off, games.data(), games.size() * sizeof(GameRec));
+		if (!extras.empty()) std::memcpy(img.data() + h.extras_off, extras.data(), extras.size() * sizeof(ExtraRec));
+		if (!pool.empty()) std::memcpy(img.data() + h.pool_off, pool.data(), pool.size());
+		return img;
+	}
+};
+
+void SplitCsv(const std::string& line, std::vector<std::string>& out) {
+	out.clear();
+	std::string cur; bool quoted = false;
+	for (size_t i = 0; i < line.size(); ++i) {
+		char c = line[i];
+		if (quoted) {
+			if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') { cur += '"'; ++i; }
+			else if (c == '"') quoted = false;
+			else cur += c;
+		}
+		else if (c == '"') quoted = true;
+		else if (c == ',') { out.push_back(cur); cur.clear(); }
+		else if (c != '\r') cur += c;
+	}
+	out.push_back(cur);
+}
+
+bool ParseFloat(const std::string& s, float& v) {
+	char* end = nullptr;
+	v = std::strtof(s.c_str(), &end);
+	return end != s.c_str();
+}
+
+bool In(float v, float lo, float hi) { return v >= lo && v <= hi; } // false for NaN
+
+// Field ranges shared by the CSV parser and the .spcat validator; nullptr when the record
+// is usable. hit rates feed std::bernoulli_distribution, so they must be in [0, 1].
+const char* CheckGame(float rtp, float hit, float vol, float max_x, float bonus_rate, float bonus_share, float bonus_spins) {
+	if (!In(rtp, 0.f, 10.f)) return "rtp out of range";
+	if (!In(hit, 0.f, 1.f)) return "hit_rate out of range";
+	if (!In(vol, 0.f, 1.f)) return "volatility out of range";
+	if (!In(max_x, 0.f, 1e9f) || max_x == 0.f) return "max_win_x out of range";
+	if (!In(bonus_rate, 0.f, 1.f)) return "bonus_rate out of range";
+	if (!In(bonus_share, 0.f, 1.f)) return "bonus_share out of range";
+	if (!In(bonus_spins, 1.f, float(kMaxBonusSpins))) return "bonus_spins out of range";
+	return nullptr;
+}
+
+const char* CheckExtra(float rtp, float cost, float hit, float vol) {
+	if (!In(rtp, 0.f, 10.f)) return "extra rtp out of range";
+	if (!In(cost, 0.f, 1e6f) || cost == 0.f) return "extra cost_mult out of range";
+	if (!In(hit, 0.f, 1.f)) return "extra hit_rate out of range";
+	if (!In(vol, -1e9f, 1.f)) return "extra volatility out of range"; // < 0: game's volatility
+	return nullptr;
+}
+
+bool EndsWith(const std::string& s, const char* suffix) {
+	size_t n = std::strlen(suffix);
+	return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+}
+
+std::vector<Game> DemoGames() {
+	Game g1{ "Mental II", 0.9606f, 0.3141f, 0.95f, 99999.0f, {
+		{"Xbet", 0.9609f, 0.40f, false},
+		{"Bloodletting Spins (100x)", 0.9611f, 100.0f, false}
+	}, 1.f / 300.f, 0.35f, 10 };
+	Game g2{ "Reactoonz", 0.9651f, 0.42f, 0.55f, 4750.0f, {
+	} };
+	Game g3{ "Blood & Shadow 2", 0.9609f, 0.2714f, 0.85f, 16161.0f, {
+		{"Xbet", 0.9605f, 1.50f, false},
+		{"Bonus Buy (100x)", 0.9603f, 100.0f, false}
+	}, 1.f / 250.f, 0.4f, 10 };
+	return { g1,g2,g3 };
+}
+
+GameCatalog::GameCatalog() = default;
+GameCatalog::~GameCatalog() { Reset(); }
+
+void GameCatalog::Reset() {
+	delete file_; file_ = nullptr;
+	image_.clear();
+	hdr_ = nullptr; games_ = nullptr; extras_ = nullptr; pool_ = nullptr;
+	live_.clear();
+}
+
+static bool Validate(const char* data, size_t size, std::string* err) {
+	auto fail = [&](const char* why) { if (err) *err = why; return false; };
+	if (size < sizeof(Header)) return fail("file too small");
+	const Header* h = reinterpret_cast<const Header*>(data);
+	if (h->magic != kMagic || h->version != kVersion) return fail("not a catalog (bad magic/version)");
+	if (h->game_count == 0) return fail("catalog has no games");
+	if (h->games_off < sizeof(Header) || h->games_off % alignof(GameRec) || h->extras_off % alignof(ExtraRec))
+		return fail("misaligned catalog sections");
+	if (h->games_off + size_t(h->game_count) * sizeof(GameRec) > size
+		|| h->extras_off + size_t(h->extra_count) * sizeof(ExtraRec) > size
+		|| h->pool_off + size_t(h->pool_bytes) > size) return fail("truncated catalog");
+	// records are read in place, so every offset in them must stay inside its section
+	const GameRec* games = reinterpret_cast<const GameRec*>(data + h->games_off);
+	const ExtraRec* extras = reinterpret_cast<const ExtraRec*>(data + h->extras_off);
+	for (uint32_t i = 0; i < h->game_count; ++i) {
+		const GameRec& r = games[i];
+		if (size_t(r.name_off) + r.name_len > h->pool_bytes) return fail("game name out of bounds");
+		if (size_t(r.extra_first) + r.extra_count > h->extra_count) return fail("game extras out of bounds");
+		if (const char* why = CheckGame(r.rtp, r.hit_rate, r.volatility, r.max_win_x, r.bonus_rate, r.bonus_share, float(r.bonus_spins))) return fail(why);
+	}
+	for (uint32_t i = 0; i < h->extra_count; ++i) {
+		const ExtraRec& e = extras[i];
+		if (size_t(e.name_off) + e.name_len > h->pool_bytes) return fail("extra name out of bounds");
+		if (const char* why = CheckExtra(e.rtp, e.cost_mult, e.hit_rate, e.volatility)) return fail(why);
+	}
+	return true;
+}
+
+bool GameCatalog::Bind(const char* data, size_t size, std::string* err) {
+	if (!Validate(data, size, err)) return false;
+	hdr_ = reinterpret_cast<const Header*>(data);
+	games_ = reinterpret_cast<const GameRec*>(data + hdr_->games_off);
+	extras_ = reinterpret_cast<const ExtraRec*>(data + hdr_->extras_off);
+	pool_ = data + hdr_->pool_off;
+	return true;
+}
+
+void GameCatalog::Assign(const std::vector<Game>& games) {
+	ImageBuilder b;
+	for (const auto& g : games) {
+		b.AddGame(g.name, g.rtp, g.hit_rate, g.volatility, g.max_win_x, g.bonus_rate, g.bonus_share, g.bonus_spins);
+		for (const auto& e : g.extras) b.AddExtra(e.name, e.rtp, e.cost_mult, e.hit_rate, e.volatility);
+	}
+	Reset();
+	image_ = b.Finish();
+	Bind(image_.data(), image_.size(), nullptr);
+}
+
+bool GameCatalog::LoadCsv(const std::string& path, std::string* err) {
+	std::ifstream f(path);
+	if (!f) { if (err) *err = "cannot open " + path; return false; }
+	ImageBuilder b;
+	std::string line; std::vector<std::string> cols;
+	for (int ln = 1; std::getline(f, line); ++ln) {
+		if (line.empty() || line[0] == '#' || line == "\r") continue;
+		SplitCsv(line, cols);
+		float v[7] = {};
+		bool ok = cols.size() >= 2;
+		const char* why = "bad row";
+		if (ok && cols[0] == "game") {
+			ok = cols.size() == 6 || cols.size() == 8 || cols.size() == 9;
+			v[6] = 10.f;
+			for (int i = 0; ok && i < (int)cols.size() - 2; ++i) ok = ParseFloat(cols[2 + i], v[i]);
+			if (ok && (why = CheckGame(v[0], v[1], v[2], v[3], v[4], v[5], v[6]))) ok = false;
+			if (ok) b.AddGame(cols[1], v[0], v[1], v[2], v[3], v[4], v[5], (int)v[6]);
+		}
+		else if (ok && cols[0] == "extra") {
+			ok = cols.size() >= 4 && cols.size() <= 6 && !b.games.empty();
+			v[2] = 0.f; v[3] = -1.f;
+			for (int i = 0; ok && i < (int)cols.size() - 2; ++i) ok = ParseFloat(cols[2 + i], v[i]);
+			if (ok && (why = CheckExtra(v[0], v[1], v[2], v[3]))) ok = false;
+			if (ok) b.AddExtra(cols[1], v[0], v[1], v[2], v[3]);
+		}
+		else ok = false;
+		if (!ok) { if (err) *err = path + ":" + std::to_string(ln) + ": " + why; return false; }
+	}
+	if (b.games.empty()) { if (err) *err = path + ": no games"; return false; }
+	Reset();
+	image_ = b.Finish();
+	return Bind(image_.data(), image_.size(), err);
+}
+
+bool GameCatalog::LoadBinary(const std::string& path, std::string* err) {
+	auto* mf = new MappedFile();
+	if (!mf->Open(path)) { delete mf; if (err) *err = "cannot map " + path; return false; }
+	if (!Validate(mf->Data(), mf->Size(), err)) { delete mf; return false; }
+	Reset();
+	file_ = mf;
+	return Bind(file_->Data(), file_->Size(), err);
+}
+
+bool GameCatalog::Load(const std::string& path, std::string* err) {
+	return EndsWith(path, ".csv") ? LoadCsv(path, err) : LoadBinary(path, err);
+}
+
+bool GameCatalog::SaveBinary(const std::string& path) const {
+	if (!hdr_) return false;
+	std::ofstream f(path, std::ios::binary);
+	f.write(reinterpret_cast<const char*>(hdr_), hdr_->pool_off + hdr_->pool_bytes);
+	return bool(f);
+}
+
+std::string_view GameCatalog::Name(int i) const {
+	const GameRec& r = games_[i];
+	return { pool_ + r.name_off, r.name_len };
+}
+
+Game& GameCatalog::Get(int i) {
+	auto it = live_.find(i);
+	if (it != live_.end()) return it->second;
+	return live_.emplace(i, Read(i)).first->second;
+}
+
+Game GameCatalog::Read(int i) const {
+	auto it = live_.find(i);
+	if (it != live_.end()) return it->second;
+	const GameRec& r = games_[i];
+	Game g{ std::string(Name(i)), r.rtp, r.hit_rate, r.volatility, r.max_win_x, {}, r.bonus_rate, r.bonus_share, (int)r.bonus_spins };
+	g.extras.reserve(r.extra_count);
+	for (uint32_t k = 0; k < r.extra_count; ++k) {
+		const ExtraRec& e = extras_[r.extra_first + k];
+		g.extras.push_back({ std::string(pool_ + e.name_off, e.name_len), e.rtp, e.cost_mult, false, e.hit_rate, e.volatility });
+	}
+	return g;
+}
+
+void GameCatalog::Search(std::string_view query, std::vector<int>& out) const {
+	out.clear();
+	const int n = Size();
+	if (query.empty()) { out.resize(n); for (int i = 0; i < n; ++i) out[i] = i; return; }
+	auto lower = [](char c) { return (char)std::tolower((unsigned char)c); };
+	for (int i = 0; i < n; ++i) {
+		std::string_view name = Name(i);
+		if (name.size() < query.size()) continue;
+		for (size_t p = 0; p + query.size() <= name.size(); ++p) {
+			size_t k = 0;
+			while (k < query.size() && lower(name[p + k]) == lower(query[k])) ++k;
+			if (k == query.size()) { out.push_back(i); break; }
+		}
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "Models.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Authoring format (CSV). One row per game, its extras on the rows right after it:
+//   game,<name>,<rtp>,<hit_rate>,<volatility>,<max_win_x>[,<bonus_rate>,<bonus_share>[,<bonus_spins>]]
+//   extra,<name>,<rtp>,<cost_mult>[,<hit_rate>[,<volatility>]]
+// An extra's hit_rate and volatility describe its own feature (see Extras.h); left out,
+// they default to cost_mult / 100 and the game's volatility.
+// Blank lines and lines starting with '#' are skipped; names may be "quoted". A row whose
+// numbers are out of range (NaN, hit rates outside [0, 1], negative volatility or max win,
+// bonus_spins outside [1, kMaxBonusSpins]) rejects the file; .spcat records are checked
+// the same way when mapped.
+//
+// Compiled format (.spcat) is the in-memory image written as-is: a header, fixed-size
+// game and extra records, and one pool of interned names. It is memory-mapped and read
+// in place, so opening a catalog costs the same for 50 games or 50k.
+
+namespace catalog {
+constexpr uint32_t kMagic = 0x31435053; // "SPC1"
+constexpr uint32_t kVersion = 3;
+constexpr uint32_t kMaxBonusSpins = 500; // per round; each one is simulated when the round's table is built
+
+struct Header {
+    uint32_t magic = kMagic;
+    uint32_t version = kVersion;
+    uint32_t game_count = 0, extra_count = 0, pool_bytes = 0;
+    uint32_t games_off = 0, extras_off = 0, pool_off = 0;
+};
+
+struct GameRec {
+    uint32_t name_off, name_len;
+    float rtp, hit_rate, volatility, max_win_x;
+    uint32_t extra_first, extra_count;
+    float bonus_rate, bonus_share;
+    uint32_t bonus_spins;
+};
+
+struct ExtraRec {
+    uint32_t name_off, name_len;
+    float rtp, cost_mult;
+    float hit_rate, volatility; // 0 / < 0: defaults, as in ExtraBet
+};
+}
+
+class MappedFile;
+
+std::vector<Game> DemoGames();
+
+class GameCatalog {
+public:
+    GameCatalog();
+    ~GameCatalog();
+    GameCatalog(const GameCatalog&) = delete;
+    GameCatalog& operator=(const GameCatalog&) = delete;
+
+    void Assign(const std::vector<Game>& games);
+    bool LoadCsv(const std::string& path, std::string* err = nullptr);
+    bool LoadBinary(const std::string& path, std::string* err = nullptr);
+    bool Load(const std::string& path, std::string* err = nullptr); // by extension
+    bool SaveBinary(const std::string& path) const;
+
+    int Size() const { return hdr_ ? (int)hdr_->game_count : 0; }
+    std::string_view Name(int i) const;
+    Game& Get(int i); // materialized on first use; edits live for the session
+    Game Read(int i) const; // copy, including session edits
+
+    // case-insensitive substring match over names, no materialization
+    void Search(std::string_view query, std::vector<int>& out) const;
+
+private:
+    std::vector<char> image_;              // owned image (CSV / demo games)
+    MappedFile* file_ = nullptr;           // or a mapped .spcat
+    const catalog::Header* hdr_ = nullptr;
+    const catalog::GameRec* games_ = nullptr;
+    const catalog::ExtraRec* extras_ = nullptr;
+    const char* pool_ = nullptr;
+    std::unordered_map<int, Game> live_;   // node-based, so Game& stays valid
+
+    bool Bind(const char* data, size_t size, std::string* err);
+    void Reset();
+};
@@ -0,0 +1,482 @@
+#include "Cli.h"
+#include "Catalog.h"
+#include "Ranking.h"
+#include "Headless.h"
+#include "Profiler.h"
+#include "Qmc.h"
+#include "Diffusion.h"
+#include "Campaign.h"
+#include "Fixed.h"
+#include "Mlmc.h"
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+// GUI subsystem builds have no console; borrow the parent's so tools can print
+static void UseParentConsole() {
+#ifdef _WIN32
+	if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+		FILE* f;
+		freopen_s(&f, "CONOUT$", "w", stdout);
+		freopen_s(&f, "CONOUT$", "w", stderr);
+	}
+#endif
+}
+
+static int CompileCatalog(const char* in, const char* out) {
+	GameCatalog cat; std::string err;
+	if (!cat.Load(in, &err)) { std::fprintf(stderr, "%s\n", err.c_str()); return 1; }
+	if (!cat.SaveBinary(out)) { std::fprintf(stderr, "cannot write %s\n", out); return 1; }
+	std::printf("%d games -> %s\n", cat.Size(), out);
+	return 0;
+}
+
+static bool LoadGames(const char* path, std::vector<Game>& games) {
+	if (!std::strcmp(path, "demo")) { games = DemoGames(); return true; }
+	GameCatalog cat; std::string err;
+	if (!cat.Load(path, &err)) { std::fprintf(stderr, "%s\n", err.c_str()); return false; }
+	games.reserve(cat.Size());
+	for (int i = 0; i < cat.Size(); ++i) games.push_back(cat.Read(i));
+	return true;
+}
+
+// session knobs shared by the tools; unknown flags are left for the caller
+static bool ParseSessionArg(int argc, char** argv, int& i, SessionInput& in, int& threads) {
+	const char* a = argv[i];
+	if (i + 1 >= argc) return false;
+	const char* v = argv[i + 1];
+	if (!std::strcmp(a, "--bankroll")) in.start_bankroll = (float)std::atof(v);
+	else if (!std::strcmp(a, "--trials")) in.trials = std::atoi(v);
+	else if (!std::strcmp(a, "--spins")) in.max_spins_cap = std::atoi(v);
+	else if (!std::strcmp(a, "--bet")) { in.lock_bet_size = true; in.user_bet_size = (float)std::atof(v); }
+	else if (!std::strcmp(a, "--minutes")) { in.include_time = true; in.target_minutes = std::atoi(v); }
+	else if (!std::strcmp(a, "--spins-per-min")) in.spins_per_min = std::max(1, std::atoi(v));
+	else if (!std::strcmp(a, "--threads")) threads = std::atoi(v);
+	else if (!std::strcmp(a, "--payout-math")) in.payout_math = v[0] == 'f' ? (std::strcmp(v, "faster") ? MathTier::Fast : MathTier::Faster) : MathTier::Exact;
+	else if (!std::strcmp(a, "--risk")) in.risk = v[0] == 'c' ? RiskProfile::Conservative : v[0] == 'a' ? RiskProfile::Aggressive : RiskProfile::Balanced;
+	else return false;
+	++i;
+	return true;
+}
+
+static int Rank(const char* catalog, const char* out, const SessionInput& in, int threads) {
+	std::vector<Game> games;
+	if (!LoadGames(catalog, games)) return 1;
+	std::vector<RankRow> rows;
+	RankGames(games, in, rows, nullptr, nullptr, threads);
+	std::sort(rows.begin(), rows.end(), [](const RankRow& a, const RankRow& b) { return a.r.prob_hit_target > b.r.prob_hit_target; });
+	if (out) {
+		if (!WriteRankingCsv(rows, out)) { std::fprintf(stderr, "cannot write %s\n", out); return 1; }
+		std::printf("%d games -> %s\n", (int)rows.size(), out);
+	}
+	else {
+		std::printf("%-32s %10s %8s %12s\n", "game", "hit_target", "ruin", "expected_end");
+		for (const auto& row : rows) std::printf("%-32s %9.1f%% %7.1f%% %12.2f\n", row.name.c_str(), row.r.prob_hit_target * 100.f, row.r.prob_ruin * 100.f, row.r.expected_end);
+	}
+	return 0;
+}
+
+// Estimator variance per second: reps independent SimulateSession runs of N trials against
+// reps scramblings of N Sobol points, single-threaded, N = trials rounded up to 2^k.
+static int BenchQmc(SessionInput in, int reps) {
+	int n = 1;
+	while (n < std::max(100, in.trials)) n <<= 1;
+	in.trials = n;
+	reps = std::max(2, reps);
+	using Clock = std::chrono::steady_clock;
+	auto var = [](const std::vector<double>& v) {
+		double m = 0, ss = 0;
+		for (double x : v) m += x;
+		m /= v.size();
+		for (double x : v) ss += (x - m) * (x - m);
+		return ss / (v.size() - 1);
+	};
+
+	std::printf("N = %d trials, %d replicates\n", n, reps);
+	std::printf("%-24s %-8s %12s %12s %9s %9s %8s\n", "game", "metric", "mc_var", "qmc_var", "mc_ms", "qmc_ms", "gain");
+	for (const Game& g : DemoGames()) {
+		std::vector<double> mc[2], qmc[2];
+		auto t0 = Clock::now();
+		for (int r = 0; r < reps; ++r) {
+			SimResult s = SimulateSession(g, in);
+			mc[0].push_back(s.prob_ruin); mc[1].push_back(s.expected_end);
+		}
+		double mc_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+		t0 = Clock::now();
+		RqmcEstimate e = SimulateSessionRqmc(g, in, n, reps, 0x5107, 1);
+		double qmc_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+		for (const auto& s : e.replicates) { qmc[0].push_back(s.prob_ruin); qmc[1].push_back(s.expected_end); }
+
+		const char* names[] = { "ruin", "end" };
+		for (int m = 0; m < 2; ++m) {
+			double vm = var(mc[m]), vq = var(qmc[m]);
+			// work-normalized: how much faster RQMC reaches the same error
+			double gain = vq > 0 ? (vm * mc_ms) / (vq * qmc_ms) : 0.0;
+			std::printf("%-24s %-8s %12.4g %12.4g %9.1f %9.1f %7.2fx\n", g.name.c_str(), names[m], vm, vq, mc_ms, qmc_ms, gain);
+		}
+	}
+	return 0;
+}
+
+// float against double bankroll arithmetic. Every trial replays the same RNG stream in
+// both, so the differences are precision drift alone: trials whose outcome flipped and the
+// shift in the mean end bankroll, next to the Monte Carlo standard error of that mean.
+static int BenchPrecision(SessionInput in, int reps) {
+	in.trials = std::max(100, in.trials);
+	reps = std::max(1, reps);
+	using Clock = std::chrono::steady_clock;
+	std::printf("%d trials x %d reps per row, single-threaded\n", in.trials, reps);
+	std::printf("%-20s %6s | %9s %9s %7s | %8s %8s | %11s %9s\n", "game", "bank", "dbl_ms", "flt_ms", "speed", "flipped", "d_ruin", "d_end", "se_end");
+	for (const Game& g : DemoGames())
+		for (float bank : { 100.f, 1000.f, 10000.f }) {
+			in.start_bankroll = bank;
+			const SessionSetup su = PrepareSession(g, in);
+			const int n = su.trials * reps;
+			double ms[2] = {}, d_end = 0, sum = 0, sum2 = 0;
+			int flipped = 0, d_ruin = 0;
+			for (int t = 0; t < n; ++t) {
+				SessionTally ta[2];
+				for (int k = 0; k < 2; ++k) {
+					RNG().seed(0x5107u + t);
+					auto t0 = Clock::now();
+					if (k) SimulateSessionTrials<float>(g, in, su, t, t + 1, ta[k]);
+					else SimulateSessionTrials<double>(g, in, su, t, t + 1, ta[k]);
+					ms[k] += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+				}
+				flipped += ta[0].ruin != ta[1].ruin || ta[0].hit_tp != ta[1].hit_tp;
+				d_ruin += ta[1].ruin - ta[0].ruin;
+				d_end += ta[1].end_sum - ta[0].end_sum;
+				sum += ta[0].end_sum; sum2 += ta[0].end_sum * ta[0].end_sum;
+			}
+			const double mean = sum / n, se = std::sqrt(std::max(0.0, sum2 / n - mean * mean) / n);
+			std::printf("%-20s %6.0f | %9.1f %9.1f %6.2fx | %8d %+7.3f%% | %+11.5f %9.3f\n", g.name.c_str(), bank, ms[0] / reps, ms[1] / reps,
+				ms[1] > 0 ? ms[0] / ms[1] : 0.0, flipped, 100.0 * d_ruin / n, d_end / n, se);
+		}
+	return 0;
+}
+
+// Diffusion preview against SimulateSession over demo games, risk profiles and bankrolls.
+static int CalibrateDiffusion(SessionInput in) {
+	std::printf("%-20s %-4s %7s | %8s %8s | %8s %8s | %9s %9s\n", "game", "risk", "bank", "ruin_mc", "ruin_bm", "tp_mc", "tp_bm", "end_mc", "end_bm");
+	const char* risks[] = { "c", "b", "a" };
+	double err_ruin = 0, err_tp = 0, err_end = 0; int rows = 0;
+	bool any_jumps = false;
+	for (const Game& g : DemoGames())
+		for (int r = 0; r < 3; ++r)
+			for (float bank : { 50.f, 100.f, 500.f }) {
+				in.risk = (RiskProfile)r;
+				in.start_bankroll = bank;
+				SimResult mc = SimulateSession(g, in);
+				DiffusionEstimate bm = DiffusionPreview(g, in);
+				std::printf("%-20s %-4s %7.0f | %7.1f%% %7.1f%% | %7.1f%% %6.1f%%%c | %9.2f %9.2f\n", g.name.c_str(), risks[r], bank,
+					mc.prob_ruin * 100.f, bm.prob_ruin * 100.f, mc.prob_hit_target * 100.f, bm.prob_hit_target * 100.f, bm.jumps ? '*' : ' ',
+					mc.expected_end, bm.expected_end);
+				any_jumps |= bm.jumps;
+				err_ruin += std::abs(mc.prob_ruin - bm.prob_ruin);
+				err_tp += std::abs(mc.prob_hit_target - bm.prob_hit_target);
+				err_end += std::abs(mc.expected_end - bm.expected_end) / bank;
+				++rows;
+			}
+	std::printf("mean abs error: ruin %.2f pts, target %.2f pts, end %.2f%% of bankroll (%d trials per MC row)\n",
+		100.0 * err_ruin / rows, 100.0 * err_tp / rows, 100.0 * err_end / rows, std::max(100, in.trials));
+	if (any_jumps) std::printf("* bonus rounds or extras: the diffusion overstates the target probability\n");
+	return 0;
+}
+
+// Every bet strategy on the same trial streams per demo game, end bankroll against flat.
+static int CompareStrategies(const SessionInput& in, int threads) {
+	CompareOptions opt;
+	opt.trials = std::max(200, in.trials);
+	opt.threads = threads;
+	std::printf("%d trials per strategy, common random numbers\n", opt.trials);
+	std::printf("%-20s %-18s %8s %8s %9s %8s %16s\n", "game", "strategy", "ruin", "target", "end", "avg_bet", "end-flat (95%)");
+	for (const Game& g : DemoGames()) {
+		std::vector<CompareConfig> cfgs;
+		for (int k = 0; k < (int)BetStrategy::Count; ++k) {
+			if ((BetStrategy)k == BetStrategy::Kelly && !KellyHasEdge(g)) continue; // zero stake: nothing to compare
+			CompareConfig c{ StrategyName((BetStrategy)k), g, in };
+			c.in.strategy.kind = (BetStrategy)k;
+			cfgs.push_back(c);
+		}
+		for (const CompareRun& r : ComparePlans(cfgs, opt))
+			std::printf("%-20s %-18s %7.1f%% %7.1f%% %9.2f %8.3f %+8.2f +/-%5.2f\n", g.name.c_str(), r.label.c_str(), r.result.prob_ruin * 100.f,
+				r.result.prob_hit_target * 100.f, r.result.expected_end, r.avg_bet, r.end.diff, r.end.ci_paired);
+	}
+	return 0;
+}
+
+// Float against integer-cent accounting on the demo games, small stakes to large. Rows
+// where whole-cent stakes or cent-floored payouts move the plan are starred.
+static int CheckFixed(SessionInput in) {
+	std::printf("%-20s %7s %6s %6s %7s | %8s %8s | %9s %9s | %7s %7s\n", "game", "bank", "plan", "bet", "rtp_cut", "ruin_f", "ruin_i", "end_f", "end_i", "ms_f", "ms_i");
+	bool any = false;
+	for (const Game& g : DemoGames())
+		for (float bank : { 10.f, 100.f, 1000.f }) {
+			in.start_bankroll = bank;
+			auto t0 = std::chrono::steady_clock::now();
+			SimResult f = SimulateSession(g, in);
+			auto t1 = std::chrono::steady_clock::now();
+			SimResult i = SimulateSessionFixed(g, in);
+			auto t2 = std::chrono::steady_clock::now();
+			const CentRounding cr = CentRoundingFor(g, f.recommended_bet);
+			any |= cr.Distorted();
+			std::printf("%-20s %7.0f %6.3f %6.2f %6.1f%%%c | %7.1f%% %7.1f%% | %9.2f %9.2f | %7.1f %7.1f\n", g.name.c_str(), bank, f.recommended_bet, i.recommended_bet,
+				cr.rtp_loss * 100.f, cr.Distorted() ? '*' : ' ', f.prob_ruin * 100.f, i.prob_ruin * 100.f, f.expected_end, i.expected_end,
+				std::chrono::duration<double, std::milli>(t1 - t0).count(), std::chrono::duration<double, std::milli>(t2 - t1).count());
+		}
+	if (any) std::printf("* stake off the plan by over 10%% or over 1%% RTP lost to cent rounding: the engines answer different questions\n");
+
+	// cent-exact with extras priced off the stake: every spin cost is whole cents and within
+	// half a cent of stake x cost_mult, and so is every trial's end with an extra on
+	int bad = 0;
+	for (float mult : { 1.015f, 1.25f, 1.4f, 2.5f, 101.5f })
+		for (money::Minor stake = money::kCent; stake <= 500 * money::kCent; stake += money::kCent) {
+			const money::Minor cost = money::SpinCost(stake, mult);
+			bad += cost % money::kCent != 0 || std::abs(double(cost) - double(stake) * mult) > money::kCent / 2;
+		}
+	Game g = DemoGames()[0];
+	g.extras[0].enabled = true; // Xbet, cost x1.40
+	for (float bank : { 10.f, 100.f }) {
+		in.start_bankroll = bank;
+		const SessionSetup su = PrepareSession(g, in);
+		for (int t = 0; t < 200; ++t) {
+			SessionTally one;
+			SimulateSessionTrialsFixed(g, in, su, t, t + 1, one);
+			bad += money::FromUnits(one.end_sum) % money::kCent != 0;
+		}
+	}
+	std::printf("cent-exact with non-integral cost_mult: %s\n", bad ? "FAILED" : "ok");
+	return bad ? 1 : 0;
+}
+
+// Fast-math tiers: kernel error over their input ranges, then payout mean and tail
+// quantiles of every demo game's lognormal on 2^20 stratified uniforms against the double
+// reference, and sampler cost. Fails when a tier's mean bias or p99.9 error is past its bound.
+static int CheckFastMath() {
+	using Clock = std::chrono::steady_clock;
+	constexpr int n = 1 << 20;
+	std::vector<float> q(n), sign(n), x(n);
+	std::vector<double> ref(n);
+	for (int i = 0; i < n; ++i) { double u = (i + 0.5) / n; q[i] = float(std::min(u, 1.0 - u)); sign[i] = u > 0.5 ? 1.f : -1.f; }
+
+	std::printf("%-7s %12s %12s %12s\n", "tier", "exp_rel", "log_rel", "invnorm_rel");
+	for (MathTier t : { MathTier::Fast, MathTier::Faster }) {
+		double e_exp = 0, e_log = 0, e_inv = 0;
+		for (int i = 0; i <= 100000; ++i) {
+			float xe = -40.f + 80.f * i / 100000, xl = std::exp(-60.f + 120.f * i / 100000);
+			float qi = float(std::pow(10.0, -9.0 * i / 100000)) * 0.5f;
+			float fe = t == MathTier::Fast ? fastmath::Exp<MathTier::Fast>(xe) : fastmath::Exp<MathTier::Faster>(xe);
+			float fl = t == MathTier::Fast ? fastmath::Log<MathTier::Fast>(xl) : fastmath::Log<MathTier::Faster>(xl);
+			float fi = t == MathTier::Fast ? fastmath::InvNormalLower<MathTier::Fast>(qi) : fastmath::InvNormalLower<MathTier::Faster>(qi);
+			e_exp = std::max(e_exp, std::abs(fe / std::exp(double(xe)) - 1.0));
+			e_log = std::max(e_log, std::abs(fl - std::log(double(xl))) / std::max(1.0, std::abs(std::log(double(xl)))));
+			e_inv = std::max(e_inv, std::abs(fi - InvNormalCdf(qi)) / std::max(1.0, std::abs(InvNormalCdf(qi))));
+		}
+		std::printf("%-7s %12.3g %12.3g %12.3g\n", MathTierName(t), e_exp, e_log, e_inv);
+	}
+
+	int failed = 0;
+	std::printf("\n%-20s %-7s %11s %11s %11s %11s %9s\n", "game", "tier", "mean_bias", "p50_err", "p99_err", "p99.9_err", "ns/draw");
+	for (const Game& g : DemoGames()) {
+		const float mean = BaseMeanOnHit(g);
+		const float sigma = 0.5f + 1.5f * std::clamp(g.volatility, 0.0f, 1.0f);
+		const float mu = std::log(std::max(1e-4f, mean)) - 0.5f * sigma * sigma;
+		double ref_mean = 0;
+		for (int i = 0; i < n; ++i) { ref[i] = std::min<double>(g.max_win_x, std::exp(mu + sigma * InvNormalCdf((i + 0.5) / n))); ref_mean += ref[i]; }
+		ref_mean /= n;
+		// per-hit std::lognormal_distribution draws, what the session loop ran before batching
+		std::mt19937 rng(1);
+		auto t0 = Clock::now();
+		float sink = 0.f;
+		for (int i = 0; i < n; ++i) { std::lognormal_distribution<float> d(mu, sigma); sink += std::min(g.max_win_x, d(rng)); }
+		const double ns_std = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / n;
+		std::printf("%-20s %-7s %11s %11s %11s %11s %9.1f%s\n", g.name.c_str(), "std", "", "", "", "", ns_std, sink < 0 ? " " : "");
+		for (MathTier t : { MathTier::Exact, MathTier::Fast, MathTier::Faster }) {
+			t0 = Clock::now();
+			for (int i = 0; i < n; i += PayoutBatch::kSize)
+				fastmath::LognormalFromUniform(t, &q[i], &sign[i], &x[i], PayoutBatch::kSize, mu, sigma, g.max_win_x);
+			const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / n;
+			double m = 0;
+			for (float v : x) m += v;
+			m /= n;
+			auto qerr = [&](double p) { size_t k = size_t(p * n); return x[k] / ref[k] - 1.0; };
+			const double bias = m / ref_mean - 1.0, e999 = qerr(0.999);
+			const double bound = t == MathTier::Faster ? 1e-3 : 1e-5;
+			const bool ok = std::abs(bias) < bound && std::abs(e999) < 10 * bound;
+			failed += !ok;
+			std::printf("%-20s %-7s %+11.2e %+11.2e %+11.2e %+11.2e %9.1f%s\n", g.name.c_str(), MathTierName(t), bias, qerr(0.5), qerr(0.99), e999, ns, ok ? "" : "  FAIL");
+		}
+	}
+	std::printf("%s\n", failed ? "FAILED" : "ok");
+	return failed ? 1 : 0;
+}
+
+// Multilevel estimator against plain SimulateSession at the same standard errors on long
+// time sessions (240 minutes at 30 spins/min unless --minutes is given), both
+// single-threaded. The Monte Carlo run gets the trial count the real level's variance
+// asks for; z is the gap between the two estimates in combined standard errors.
+static int BenchMlmc(SessionInput in, float tol) {
+	if (!in.include_time) { in.include_time = true; in.target_minutes = 240; in.spins_per_min = 30; }
+	MlmcOptions opt;
+	opt.tol_prob = opt.tol_end = std::max(1e-4f, tol);
+	opt.threads = 1;
+	using Clock = std::chrono::steady_clock;
+	std::printf("%d spins per session, target se %.3g (end: x bankroll)\n", in.target_minutes * std::max(1, in.spins_per_min), opt.tol_prob);
+	for (const Game& g : DemoGames()) {
+		auto t0 = Clock::now();
+		const MlmcResult m = SimulateSessionMlmc(g, in, opt);
+		const double mlmc_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+		SessionInput mc_in = in;
+		mc_in.trials = std::max(100, m.mc_trials);
+		t0 = Clock::now();
+		const SimResult s = SimulateSession(g, mc_in);
+		const double mc_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+		std::printf("%s: bet %.2f, %s, %d levels, work %.3g steps vs %.3g spins (%.1fx), %.0f ms vs %.0f ms (%.1fx)\n", g.name.c_str(), m.result.recommended_bet,
+			m.multilevel ? "multilevel" : "plain MC", (int)m.levels.size(), m.steps, m.mc_steps, m.steps > 0 ? m.mc_steps / m.steps : 0.0, mlmc_ms, mc_ms, mlmc_ms > 0 ? mc_ms / mlmc_ms : 0.0);
+		std::printf("  %6s %9s %8s %11s %11s %11s\n", "block", "samples", "cost", "var_ruin", "var_tp", "var_end");
+		for (const MlmcLevel& lv : m.levels)
+			std::printf("  %6d %9d %8.1f %11.4g %11.4g %11.4g\n", lv.block, lv.samples, lv.cost, lv.var[0], lv.var[1], lv.var[2]);
+		const float est[3] = { m.result.prob_ruin, m.result.prob_hit_target, m.result.expected_end }, se[3] = { m.se_ruin, m.se_hit_target, m.se_end };
+		const float mc[3] = { s.prob_ruin, s.prob_hit_target, s.expected_end };
+		const char* names[] = { "ruin", "target", "end" };
+		for (int i = 0; i < 3; ++i) {
+			const double mc_se = std::sqrt(m.real_var[i] / mc_in.trials), z = (est[i] - mc[i]) / std::max(1e-12, std::sqrt(se[i] * se[i] + mc_se * mc_se));
+			std::printf("  %-6s mlmc %10.4f +- %-8.4f mc %10.4f +- %-8.4f z %+5.2f\n", names[i], est[i], se[i], mc[i], mc_se, z);
+		}
+	}
+	return 0;
+}
+
+// Campaign kernel per demo game, with the path-by-path reference beside it when check > 0.
+static int RunCampaign(const SessionInput& in, CampaignInput c, int check) {
+	const int every = std::max(1, c.sessions / 10);
+	for (const Game& g : DemoGames()) {
+		auto t0 = std::chrono::steady_clock::now();
+		const CampaignResult k = SimulateCampaign(g, in, c);
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+		std::printf("%s: %d sessions from %.0f, kernel %.0f ms, grid to %.0f (%.2f%% clamped)\n", g.name.c_str(), c.sessions, in.start_bankroll, ms, k.grid_max, k.clamped * 100.f);
+		CampaignResult p;
+		if (check > 0) {
+			t0 = std::chrono::steady_clock::now();
+			p = SimulateCampaignPaths(g, in, c, check);
+			std::printf("  %d paths %.0f ms, shown as kernel/paths\n", check, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+		}
+		std::printf("  %8s %13s %17s %17s %17s %17s\n", "session", "ruin", "mean", "p10", "p50", "p90");
+		for (int s = 0; s <= c.sessions; s = s == c.sessions ? s + 1 : std::min(c.sessions, s + every)) {
+			if (check > 0)
+				std::printf("  %8d %5.1f%%/%5.1f%% %8.1f/%8.1f %8.1f/%8.1f %8.1f/%8.1f %8.1f/%8.1f\n", s, k.ruin[s] * 100.f, p.ruin[s] * 100.f,
+					k.mean[s], p.mean[s], k.p10[s], p.p10[s], k.p50[s], p.p50[s], k.p90[s], p.p90[s]);
+			else
+				std::printf("  %8d %12.1f%% %17.1f %17.1f %17.1f %17.1f\n", s, k.ruin[s] * 100.f, k.mean[s], k.p10[s], k.p50[s], k.p90[s]);
+		}
+		std::printf("  deposited %.1f, withdrawn %.1f", k.deposited.back(), k.withdrawn.back());
+		if (check > 0) std::printf(" (paths %.1f, %.1f)", p.deposited.back(), p.withdrawn.back());
+		std::printf("\n");
+	}
+	return 0;
+}
+
+// MLMC's ruin odds against plain Monte Carlo over `seeds` seeds with the multilevel
+// estimator forced on. Each seed must land within 3.5 combined standard errors, and the
+// mean z over seeds within 3 / sqrt(seeds): a bias in the body/jump split pushes every
+// seed the same way long before one run shows it.
+static int CheckMlmc(SessionInput in, int seeds) {
+	if (!in.include_time) { in.include_time = true; in.target_minutes = 60; in.spins_per_min = 30; }
+	seeds = std::max(2, seeds);
+	MlmcOptions opt;
+	opt.method = MlmcMethod::Multilevel;
+	opt.tol_prob = opt.tol_end = 0.01f;
+	bool ok = true;
+	std::printf("%d spins per session, %d seeds, ruin: mlmc vs plain MC\n", in.target_minutes * std::max(1, in.spins_per_min), seeds);
+	for (const Game& g : DemoGames()) {
+		double z_sum = 0.0, z_max = 0.0;
+		for (int k = 0; k < seeds; ++k) {
+			opt.seed = hashing::Mix(0x3a1c, uint64_t(k));
+			const MlmcResult m = SimulateSessionMlmc(g, in, opt);
+			SessionInput mc_in = in;
+			mc_in.trials = std::max(1000, m.mc_trials);
+			const SimResult s = SimulateSession(g, mc_in);
+			const double mc_se = std::sqrt(m.real_var[0] / mc_in.trials);
+			const double z = (m.result.prob_ruin - s.prob_ruin) / std::max(1e-9, std::sqrt(double(m.se_ruin) * m.se_ruin + mc_se * mc_se));
+			z_sum += z;
+			z_max = std::max(z_max, std::abs(z));
+			std::printf("  %-18s seed %2d  mlmc %.4f +- %.4f  mc %.4f +- %.4f  z %+5.2f\n", g.name.c_str(), k, m.result.prob_ruin, m.se_ruin, s.prob_ruin, mc_se, z);
+		}
+		const double z_mean = z_sum / seeds;
+		const bool g_ok = z_max <= 3.5 && std::abs(z_mean) * std::sqrt(double(seeds)) <= 3.0;
+		std::printf("%s: mean z %+.2f (bound %.2f), max |z| %.2f: %s\n", g.name.c_str(), z_mean, 3.0 / std::sqrt(double(seeds)), z_max, g_ok ? "ok" : "FAILED");
+		ok = ok && g_ok;
+	}
+	return ok ? 0 : 1;
+}
+
+int RunCli(int argc, char** argv, CliOptions& opts) {
+	const char* tool = nullptr;
+	const char* tool_arg = nullptr;
+	const char* out = nullptr;
+	const char* trace = nullptr;
+	SessionInput in{};
+	int threads = 0;
+	UiBenchOptions bench;
+	int reps = 16;
+	CampaignInput camp;
+	int check = 0;
+	float tol = 0.005f;
+	for (int i = 1; i < argc; ++i) {
+		const char* a = argv[i];
+		if (!std::strcmp(a, "--compile-catalog") && i + 2 < argc) {
+			UseParentConsole();
+			return CompileCatalog(argv[i + 1], argv[i + 2]);
+		}
+		if (!std::strcmp(a, "--rank") && i + 1 < argc) { tool = a; tool_arg = argv[++i]; }
+		else if (!std::strcmp(a, "--bench-ui")) { tool = a; if (i + 1 < argc && argv[i + 1][0] != '-') bench.scenario = argv[++i]; }
+		else if (!std::strcmp(a, "--bench-qmc") || !std::strcmp(a, "--calibrate-diffusion") || !std::strcmp(a, "--compare-strategies")) tool = a;
+		else if (!std::strcmp(a, "--campaign") || !std::strcmp(a, "--check-fixed") || !std::strcmp(a, "--bench-precision") || !std::strcmp(a, "--check-fastmath")) tool = a;
+		else if (!std::strcmp(a, "--bench-mlmc") || !std::strcmp(a, "--check-mlmc")) tool = a;
+		else if (!std::strcmp(a, "--tol") && i + 1 < argc) tol = (float)std::atof(argv[++i]);
+		else if (!std::strcmp(a, "--sessions") && i + 1 < argc) camp.sessions = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(a, "--deposit") && i + 1 < argc) camp.deposit = (float)std::atof(argv[++i]);
+		else if (!std::strcmp(a, "--withdraw-above") && i + 1 < argc) camp.withdraw_above = (float)std::atof(argv[++i]);
+		else if (!std::strcmp(a, "--quit-below") && i + 1 < argc) camp.quit_below = (float)std::atof(argv[++i]);
+		else if (!std::strcmp(a, "--check") && i + 1 < argc) check = std::atoi(argv[++i]);
+		else if (!std::strcmp(a, "--reps") && i + 1 < argc) reps = std::atoi(argv[++i]);
+		else if (!std::strcmp(a, "--frames") && i + 1 < argc) bench.frames = std::atoi(argv[++i]);
+		else if (!std::strcmp(a, "--out") && i + 1 < argc) out = argv[++i];
+		else if (!std::strcmp(a, "--trace") && i + 1 < argc) trace = argv[++i];
+		else if (!std::strcmp(a, "--catalog") && i + 1 < argc) opts.catalog = argv[++i];
+		else ParseSessionArg(argc, argv, i, in, threads);
+	}
+	if (!tool) return -1;
+	UseParentConsole();
+	if (trace) {
+		if (!prof::kEnabled) std::fprintf(stderr, "--trace: profiling compiled out (define SP_PROFILE)\n");
+		prof::StartTrace();
+	}
+	int rc;
+	if (!std::strcmp(tool, "--bench-ui")) {
+		bench.catalog = opts.catalog;
+		rc = RunUiBench(bench);
+	}
+	else if (!std::strcmp(tool, "--bench-qmc")) rc = BenchQmc(in, reps);
+	else if (!std::strcmp(tool, "--calibrate-diffusion")) rc = CalibrateDiffusion(in);
+	else if (!std::strcmp(tool, "--compare-strategies")) rc = CompareStrategies(in, threads);
+	else if (!std::strcmp(tool, "--check-fixed")) rc = CheckFixed(in);
+	else if (!std::strcmp(tool, "--check-fastmath")) rc = CheckFastMath();
+	else if (!std::strcmp(tool, "--bench-precision")) rc = BenchPrecision(in, reps);
+	else if (!std::strcmp(tool, "--bench-mlmc")) rc = BenchMlmc(in, tol);
+	else if (!std::strcmp(tool, "--check-mlmc")) rc = CheckMlmc(in, reps);
+	else if (!std::strcmp(tool, "--campaign")) { camp.threads = threads; rc = RunCampaign(in, camp, check); }
+	else rc = Rank(tool_arg, out, in, threads);
+	if (trace && !prof::WriteTrace(trace)) { std::fprintf(stderr, "cannot write %s\n", trace); return 1; }
+	return rc;
+}
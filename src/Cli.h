@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+
+struct CliOptions {
+    std::string catalog; // --catalog <path>: open this catalog in the UI
+};
+
+// Handles command-line tools. Returns an exit code when a tool ran, or -1 to start the UI.
+//   --compile-catalog <in.csv> <out.spcat>
+//   --rank <catalog|demo> [--out file.csv] [session options]
+//   --bench-ui [idle|band|catalog|all] [--frames N] [--catalog path]
+//   --bench-qmc [--reps N]              QMC vs plain MC variance per second
+//   --bench-precision [--reps N]        float vs double bankroll arithmetic
+//   --bench-mlmc [--tol X]              multilevel vs plain MC at the same standard error
+//   --check-mlmc [--reps N]             multilevel ruin odds against plain MC over N seeds
+//   --calibrate-diffusion               instant estimate against the simulator
+//   --compare-strategies                every bet strategy against flat, same trial streams
+//   --check-fixed                       integer-cent engine against the float one
+//   --check-fastmath                    payout math tiers: error, tail quantiles, ns per draw
+//   --campaign [--sessions N] [--deposit X] [--withdraw-above X] [--quit-below X]
+//              [--check N]              multi-session kernel, --check: against N paths
+//   --trace <file.json>                 Chrome trace of the tool run (SP_PROFILE builds)
+//   --catalog <path>                    open this catalog in the UI
+// Session options: --bankroll X --trials N --spins N --bet X --minutes N --spins-per-min N
+//   --risk conservative|balanced|aggressive --payout-math exact|fast|faster --threads N
+int RunCli(int argc, char** argv, CliOptions& opts);
@@ -0,0 +1,230 @@
+#pragma once
+#include "Hash.h"
+#include "Strategy.h"
+#include "TaskPool.h"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Paired comparison with common random numbers. Trial t of every configuration reads the
+// same uniform stream (seeded by trial index), and every spin consumes exactly two
+// uniforms (hit, payout) drawn by inverse transform, so the configurations see the same
+// luck spin for spin. Their differences then have far less noise than two independent
+// runs, and the paired confidence interval shows it.
+
+// Acklam's rational approximation of the standard normal quantile, |rel err| < 1.2e-9
+inline double InvNormalCdf(double p) {
+	static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+	static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+	static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+	static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+	const double lo = 0.02425, hi = 1.0 - lo;
+	if (p < lo) {
+		double q = std::sqrt(-2.0 * std::log(p));
+		return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+	}
+	if (p > hi) {
+		double q = std::sqrt(-2.0 * std::log(1.0 - p));
+		return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+	}
+	double q = p - 0.5, r = q * q;
+	return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+// same lognormal as PayoutBatch, from a uniform
+inline float PayoutFromUniform(float mean_on_hit, float volatility, float max_x, double u) {
+	float sigma = 0.5f + 1.5f * std::clamp(volatility, 0.0f, 1.0f);
+	float mu = std::log(std::max(1e-4f, mean_on_hit)) - 0.5f * sigma * sigma;
+	float x = std::exp(mu + sigma * float(InvNormalCdf(u)));
+	return x > max_x ? max_x : x;
+}
+
+struct CompareConfig {
+	std::string label;
+	Game game;
+	SessionInput in; // in.strategy sizes the bets, flat by default
+};
+
+struct TrialOutcome {
+	bool hit_tp = false, ruin = false;
+	double end = 0.0;
+	double staked = 0.0; // sum of bets, before cost_mult
+	int spins = 0;
+};
+
+// One SimulateSessionTrials trial on a uniform stream (anything with Uniform(), e.g.
+// TrialRng) with bets sized by a BetPolicy; record(k, bank) at each idx spin. Features
+// draw from rng.Fork(), so enabling an extra leaves the base game's draws alone.
+template<class Strategy, class Rng, class Record>
+inline TrialOutcome RunStrategyTrial(const Game& g, const SessionInput& in, const SessionSetup& su, Strategy strat, Rng rng, const std::vector<int>& idx, Record&& record) {
+	const SimResult& plan = su.plan;
+	const float mean_on_hit = BaseMeanOnHit(g);
+	const bool extras = su.extras.Count() > 0;
+	TrialRng xsrc = rng.Fork(0xe7a5);
+	ExtraBatch batch;
+	if (extras) batch.Reset(su.extras, xsrc);
+	TrialOutcome o;
+	double bank = in.start_bankroll;
+	int next = 0;
+	if (!idx.empty() && idx[0] == 0) record(next++, float(bank));
+	int s = 0;
+	for (; s < plan.planned_spins; ++s) {
+		double u_hit = rng.Uniform(), u_pay = rng.Uniform(); // fixed draws per spin keep streams aligned
+		const float bet = strat.Bet(bank, su.cost_mult);
+		if (bet <= 0.f) break;
+		const double bet_total = bet * su.cost_mult;
+		bank -= bet_total;
+		double won = 0.0;
+		if (u_hit < g.hit_rate) { won = bet * PayoutFromUniform(mean_on_hit, g.volatility, g.max_win_x, u_pay); bank += won; }
+		if (extras) { double x = bet * batch.Next(su.extras, xsrc); won += x; bank += x; }
+		strat.Settle(won > bet_total);
+		o.staked += bet; ++o.spins;
+		if (bank >= plan.take_profit) { o.hit_tp = true; break; }
+		if (bank <= plan.stop_loss) { o.ruin = true; break; }
+		if (next < (int)idx.size() && idx[next] == s + 1) record(next++, float(bank));
+	}
+	for (; next < (int)idx.size(); ++next) record(next, float(bank)); // flat after the session stops
+	o.end = bank;
+	return o;
+}
+
+// bets sized by the session's strategy
+template<class Rng, class Record>
+inline TrialOutcome RunCrnTrial(const Game& g, const SessionInput& in, const SessionSetup& su, Rng rng, const std::vector<int>& idx, Record&& record) {
+	return VisitStrategy(su.strategy, [&](const auto& strat) { return RunStrategyTrial(g, in, su, strat, rng, idx, record); });
+}
+
+// mean difference (config - baseline) with 95% half-widths
+struct PairedStat {
+	double a = 0.0, b = 0.0, diff = 0.0;
+	double ci_paired = 0.0;      // from the per-trial differences
+	double ci_independent = 0.0; // what two unpaired runs of the same size would give
+};
+
+struct CompareRun {
+	std::string label;
+	SimResult result;
+	PathBands bands;
+	double avg_bet = 0.0; // mean stake per spin
+	PairedStat ruin, hit_target, end; // vs runs[0]; zero for the baseline itself
+};
+
+struct CompareOptions {
+	int trials = 2000;
+	int band_points = 200;
+	uint64_t seed = 0x5107; // fixed by default so a rerun reproduces the numbers
+	int threads = 0;
+};
+
+// done counts finished trials (of opt.trials); a set cancel stops between chunks and
+// returns no runs
+inline std::vector<CompareRun> ComparePlans(const std::vector<CompareConfig>& cfgs, const CompareOptions& opt,
+	std::atomic<int>* done = nullptr, const std::atomic<bool>* cancel = nullptr) {
+	SP_PROFILE_SCOPE("ComparePlans");
+	const int n = std::max(2, opt.trials), nc = (int)cfgs.size();
+	std::vector<CompareRun> runs(nc);
+	if (!nc) return runs;
+
+	struct Lane {
+		SessionSetup su;
+		std::vector<int> idx;
+		std::vector<float> snap;           // step-major, points x trials
+		std::vector<TrialOutcome> outcome; // per trial
+	};
+	std::vector<Lane> lanes(nc);
+	for (int c = 0; c < nc; ++c) {
+		Lane& l = lanes[c];
+		l.su = PrepareSession(cfgs[c].game, cfgs[c].in);
+		l.idx = BandStepIndices(l.su.plan.planned_spins, { opt.band_points, false });
+		l.snap.resize(l.idx.size() * size_t(n));
+		l.outcome.resize(n);
+	}
+
+	constexpr int kChunk = 64;
+	TaskPool::ParallelFor((n + kChunk - 1) / kChunk, [&](int chunk) {
+		if (cancel && *cancel) return;
+		const int t1 = std::min(n, (chunk + 1) * kChunk);
+		for (int t = chunk * kChunk; t < t1; ++t)
+			for (int c = 0; c < nc; ++c) {
+				Lane& l = lanes[c];
+				l.outcome[t] = RunCrnTrial(cfgs[c].game, cfgs[c].in, l.su, TrialRng(opt.seed, t), l.idx,
+					[&](int k, float v) { l.snap[size_t(k) * n + t] = v; });
+			}
+		if (done) *done += t1 - chunk * kChunk;
+	}, opt.threads);
+	if (cancel && *cancel) return {};
+
+	auto metric = [](const TrialOutcome& o, int m) { return m == 0 ? double(o.ruin) : m == 1 ? double(o.hit_tp) : o.end; };
+	for (int c = 0; c < nc; ++c) {
+		Lane& l = lanes[c];
+		CompareRun& r = runs[c];
+		r.label = cfgs[c].label;
+
+		SessionTally tally;
+		tally.trials = n;
+		double staked = 0.0; int64_t spins = 0;
+		for (const auto& o : l.outcome) { tally.hit_tp += o.hit_tp; tally.ruin += o.ruin; tally.end_sum += o.end; staked += o.staked; spins += o.spins; }
+		r.result = SessionResult(l.su, tally);
+		r.avg_bet = spins ? staked / spins : 0.0;
+
+		BandSetup b; b.spins = l.su.plan.planned_spins; b.idx = l.idx;
+		r.bands = AllocBands(b);
+		FillBands(r.bands, l.snap.data(), n, opt.threads);
+
+		if (c == 0) continue;
+		PairedStat* stats[] = { &r.ruin, &r.hit_target, &r.end };
+		for (int m = 0; m < 3; ++m) {
+			double sa = 0, sb = 0, saa = 0, sbb = 0, sd = 0, sdd = 0;
+			for (int t = 0; t < n; ++t) {
+				double a = metric(lanes[0].outcome[t], m), v = metric(l.outcome[t], m), d = v - a;
+				sa += a; sb += v; saa += a * a; sbb += v * v; sd += d; sdd += d * d;
+			}
+			auto var = [n](double s, double ss) { return std::max(0.0, (ss - s * s / n) / (n - 1)); };
+			PairedStat& p = *stats[m];
+			p.a = sa / n; p.b = sb / n; p.diff = sd / n;
+			p.ci_paired = 1.96 * std::sqrt(var(sd, sdd) / n);
+			p.ci_independent = 1.96 * std::sqrt((var(sa, saa) + var(sb, sbb)) / n);
+		}
+	}
+	return runs;
+}
+
+// ComparePlans on a background thread, polled from the UI like RankingRun
+class ComparisonRun {
+public:
+	~ComparisonRun() { Stop(); }
+
+	void Start(std::vector<CompareConfig> cfgs, const CompareOptions& opt, std::function<void()> on_done = {}) {
+		Stop();
+		cfgs_ = std::move(cfgs);
+		total_ = std::max(2, opt.trials);
+		done_ = 0; cancel_ = false; finished_ = false;
+		worker_ = std::thread([this, opt, on_done] {
+			runs_ = ComparePlans(cfgs_, opt, &done_, &cancel_);
+			finished_ = true;
+			if (on_done) on_done();
+		});
+	}
+	void Stop() {
+		cancel_ = true;
+		if (worker_.joinable()) worker_.join();
+	}
+	bool Running() const { return worker_.joinable() && !finished_; }
+	bool Finished() const { return finished_; }
+	bool Cancelled() const { return cancel_; }
+	int Done() const { return done_; }
+	int Total() const { return total_; }
+	std::vector<CompareRun>& Runs() { return runs_; }
+
+private:
+	std::vector<CompareConfig> cfgs_;
+	std::vector<CompareRun> runs_;
+	std::thread worker_;
+	std::atomic<int> done_{ 0 };
+	std::atomic<bool> cancel_{ false }, finished_{ false };
+	int total_ = 0;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include "Models.h"
+#include "Hash.h"
+#include <chrono>
+#include <cstdint>
+
+// Input fingerprints for the derived values the planner shows. Each derived value is a
+// DepNode holding the key it was computed from; a node is stale when the key of its
+// inputs differs. Keys chain (game -> plan -> result -> bands), so an edit only reaches
+// the nodes downstream of it.
+//
+//   game   : Game fields, extras, bonus round  -> effective RTP / cost
+//   plan   : game + bankroll, risk, time, bet   -> suggested bet, take-profit, stop-loss
+//   result : plan + trials, payout math, strategy -> SimResult
+//   bands  : result + band resolution, budget   -> PathBands
+namespace deps {
+
+using hashing::Mix;
+
+inline uint64_t GameKey(int idx, const Game& g) {
+	uint64_t h = Mix(Mix(Mix(Mix(Mix(0, idx), g.rtp), g.hit_rate), g.volatility), g.max_win_x);
+	h = Mix(h, (int)g.extras.size());
+	for (const auto& e : g.extras) h = Mix(Mix(Mix(Mix(Mix(h, e.rtp), e.cost_mult), e.enabled), e.hit_rate), e.volatility);
+	h = Mix(Mix(Mix(h, g.bonus_rate), g.bonus_share), g.bonus_spins);
+	return h;
+}
+
+inline uint64_t PlanKey(uint64_t game, const SessionInput& in) {
+	uint64_t h = Mix(Mix(game, in.start_bankroll), (int)in.risk);
+	h = Mix(Mix(Mix(h, in.include_time), in.target_minutes), in.spins_per_min);
+	h = Mix(Mix(Mix(h, in.lock_bet_size), in.user_bet_size), in.max_spins_cap);
+	return h;
+}
+
+inline uint64_t StrategyKey(uint64_t h, const StrategyParams& p) {
+	h = Mix(Mix(Mix(Mix(h, int(p.kind)), p.fraction), p.kelly_scale), p.min_bet_frac);
+	return Mix(Mix(Mix(Mix(h, p.ramp_mult), p.ramp_steps), p.ramp_on_win), p.max_doublings);
+}
+
+inline uint64_t ResultKey(uint64_t plan, const SessionInput& in) { return StrategyKey(Mix(Mix(plan, in.trials), int(in.payout_math)), in.strategy); }
+
+}
+
+struct DepNode {
+	uint64_t key = 0;
+	bool valid = false;
+
+	bool Stale(uint64_t k) const { return !valid || k != key; }
+	void Mark(uint64_t k) { key = k; valid = true; }
+	void Invalidate() { valid = false; }
+};
+
+// Holds expensive recomputes back while the user is still editing: settled once no
+// widget is active and the inputs have not changed for kQuietMs.
+class Debouncer {
+public:
+	using Clock = std::chrono::steady_clock;
+	static constexpr int kQuietMs = 250;
+
+	// call every frame with the combined input key
+	void Observe(uint64_t key, bool editing, Clock::time_point now = Clock::now()) {
+		if (key != last_key_ || editing) { last_key_ = key; last_change_ = now; }
+	}
+	bool Settled(Clock::time_point now = Clock::now()) const { return now - last_change_ >= std::chrono::milliseconds(kQuietMs); }
+
+private:
+	uint64_t last_key_ = 0;
+	Clock::time_point last_change_{};
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include "Simulator.h"
+#include <cmath>
+
+// Closed-form preview of a session: the bankroll as Brownian motion with the per-spin
+// drift and variance of SimulateSession's spin, absorbed at stop-loss and take-profit.
+// Infinite-horizon exit probabilities and exit time are exact for the diffusion; the
+// spin cap is handled by subtracting the eigenfunction series of the paths still alive
+// at the horizon, which converges fast once the horizon is not tiny. Ignores overshoot,
+// so big-payout games land past take-profit in the simulation more often than here.
+//
+// Bonus rounds and extras break the diffusion: they pay in rare lumps, and spreading their
+// variance over every spin sends far more paths to take-profit than reach it. On the demo
+// games the target probability comes out about twice the simulation's (9 points mean
+// error in --calibrate-diffusion against 3 without features), so DiffusionEstimate::jumps
+// flags it as unreliable. Ruin and the expected end hold up.
+
+// bankroll change of one spin of the session's plan bet
+inline SpinMoments SpinIncrementMoments(const Game& g, const SessionSetup& su) {
+	return SpinIncrementMoments(g, su.plan.recommended_bet, su.cost_mult, su.extras);
+}
+
+struct DiffusionEstimate {
+	float prob_ruin = 0.f, prob_hit_target = 0.f;
+	float expected_end = 0.f;
+	float expected_spins = 0.f; // E[min(exit, horizon)]
+	bool jumps = false;         // features pay in lumps: prob_hit_target is unreliable
+};
+
+// Two-barrier exit for drift mu, variance var per spin, start y inside (0, L), horizon n.
+inline DiffusionEstimate TwoBarrierExit(double mu, double var, double y, double L, double n) {
+	DiffusionEstimate e;
+	if (L <= 0.0 || var <= 0.0) return e;
+	y = std::clamp(y, 0.0, L);
+	const double pi = 3.14159265358979323846;
+	const double a = mu / var; // exponential tilt
+
+	// infinite horizon
+	double p_up, t_exit;
+	if (std::abs(a * L) < 1e-8) { p_up = y / L; t_exit = y * (L - y) / var; }
+	else {
+		// written to stay finite for large |a L|
+		auto ratio = [&](double u) { return -std::expm1(-2.0 * a * u); };
+		p_up = ratio(y) / ratio(L);
+		t_exit = (p_up * L - y) / mu;
+	}
+
+	// paths alive at the horizon: eigenfunction series of the absorbed density, with the
+	// tilt folded into each term's exponent so strong drifts don't overflow
+	double up_tail = 0.0, down_tail = 0.0, t_tail = 0.0;
+	const double drift_decay = mu * mu / (2.0 * var);
+	for (int k = 1; k <= 4000; ++k) {
+		const double beta = k * pi / L;
+		const double kappa = drift_decay + 0.5 * var * beta * beta;
+		const double s = std::sin(beta * y), sign = (k & 1) ? -1.0 : 1.0;
+		const double w_up = std::exp(a * (L - y) - kappa * n) / kappa;
+		const double w_down = std::exp(-a * y - kappa * n) / kappa;
+		up_tail += beta * sign * s * w_up;
+		down_tail += beta * s * w_down;
+		// integral of e^{a z} sin(beta z) over [0, L], times the tilt
+		t_tail += s * beta * (w_down - sign * w_up) / (a * a + beta * beta);
+		if (k > 8 && beta * (w_up + w_down) < 1e-14) break;
+	}
+	const double p_up_n = p_up + var / L * up_tail;
+	const double p_down_n = (1.0 - p_up) - var / L * down_tail;
+	const double t_n = t_exit - 2.0 / L * t_tail;
+
+	e.prob_hit_target = float(std::clamp(p_up_n, 0.0, 1.0));
+	e.prob_ruin = float(std::clamp(p_down_n, 0.0, 1.0));
+	e.expected_spins = float(std::clamp(t_n, 0.0, n));
+	return e;
+}
+
+inline DiffusionEstimate DiffusionPreview(const Game& g, const SessionInput& in, const SessionSetup& su) {
+	const SpinMoments m = SpinIncrementMoments(g, su);
+	const double lo = su.plan.stop_loss, hi = su.plan.take_profit;
+	DiffusionEstimate e = TwoBarrierExit(m.mean, m.var, in.start_bankroll - lo, hi - lo, su.plan.planned_spins);
+	// optional stopping: X_t - mean * t is a martingale
+	e.expected_end = float(in.start_bankroll + m.mean * e.expected_spins);
+	e.jumps = su.extras.Count() > 0;
+	return e;
+}
+
+inline DiffusionEstimate DiffusionPreview(const Game& g, const SessionInput& in) {
+	return DiffusionPreview(g, in, PrepareSession(g, in));
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include "Models.h"
+#include "Feature.h"
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// Features as their own payout processes: the game's free-spin round (bonus_rate,
+// bonus_share) and each enabled extra. A feature pays with probability hit per spin, one
+// whole round drawn from its FeatureTable and scaled to mean rtp * cost_mult / hit. An
+// extra's default hit prices a round at kFeaturePriceX bets, so a 100x bonus buy pays on
+// every purchase and a 0.4x ante one spin in 250, with the payout to match.
+//
+// ExtraBatch draws all features for kSpins spins at once: per feature it jumps from one
+// hit to the next with geometric gaps and adds into one per-spin array, so the spin loop
+// adds a single value and never branches on features. Spins a trial doesn't reach are
+// dropped, they're independent of what came before.
+
+constexpr float kFeaturePriceX = 100.f;
+
+// RTP and stake multiple of a spin with every enabled extra bought, blended by cost
+inline void ComputeEffectiveGame(const Game& g, float& rtp_eff, float& cost_mult_eff) {
+	rtp_eff = g.rtp;
+	cost_mult_eff = 1.0f;
+	for (const auto& e : g.extras) if (e.enabled) {
+		float extra_cost = e.cost_mult;
+		float old_cost = cost_mult_eff;
+		cost_mult_eff += extra_cost;
+		rtp_eff = (rtp_eff * old_cost + extra_cost * e.rtp) / cost_mult_eff;
+	}
+}
+
+inline float ExtraHitRate(const ExtraBet& e) {
+	return std::clamp(e.hit_rate > 0.f ? e.hit_rate : e.cost_mult / kFeaturePriceX, 1e-6f, 1.f);
+}
+
+inline bool HasBonusRound(const Game& g) { return g.bonus_rate > 0.f && g.bonus_share > 0.f; }
+
+// mean payout multiple of a base-game hit, net of what the bonus round pays
+inline float BaseMeanOnHit(const Game& g) {
+	const float share = HasBonusRound(g) ? std::clamp(g.bonus_share, 0.f, 1.f) : 0.f;
+	return g.rtp * (1.f - share) / std::max(0.001f, g.hit_rate);
+}
+
+// bonus round first (when the game has one), then enabled extras; structure of arrays
+struct ExtraProcess {
+	std::vector<float> hit, scale; // scale: mean round payout in base bets
+	std::vector<std::shared_ptr<const FeatureTable>> table;
+	float max_x = 0.f;
+
+	int Count() const { return (int)hit.size(); }
+	float Draw(int j, double u) const { return std::min(max_x, scale[j] * table[j]->Sample(u)); }
+	// E[payout | hit] and E[payout^2 | hit], cap included
+	void Moments(int j, double& m1, double& m2) const {
+		m1 = m2 = 0.0;
+		for (float x : table[j]->x) { double y = std::min(max_x, scale[j] * x); m1 += y; m2 += y * y; }
+		m1 /= FeatureTable::kEntries; m2 /= FeatureTable::kEntries;
+	}
+};
+
+inline ExtraProcess PrepareExtras(const Game& g) {
+	ExtraProcess x;
+	x.max_x = g.max_win_x;
+	auto add = [&](float h, float mean, float vol) {
+		x.hit.push_back(h);
+		x.scale.push_back(mean / h);
+		x.table.push_back(FeatureTableFor({ g.bonus_spins, g.hit_rate, vol }));
+	};
+	if (HasBonusRound(g)) add(std::clamp(g.bonus_rate, 1e-6f, 1.f), g.rtp * std::clamp(g.bonus_share, 0.f, 1.f), g.volatility);
+	for (const auto& e : g.extras) if (e.enabled && e.cost_mult > 0.f)
+		add(ExtraHitRate(e), e.rtp * e.cost_mult, e.volatility >= 0.f ? e.volatility : g.volatility);
+	return x;
+}
+
+// mean and variance of one spin's bankroll change, for the diffusion preview and Kelly
+struct SpinMoments {
+	double mean = 0.0, var = 0.0;
+};
+
+inline double NormalCdf(double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); }
+
+// E[min(Y, cap)] and E[min(Y, cap)^2] for PayoutBatch's lognormal Y
+inline void CappedPayoutMoments(float mean_on_hit, float volatility, float max_x, double& m1, double& m2) {
+	const double sigma = 0.5 + 1.5 * std::clamp(volatility, 0.0f, 1.0f);
+	const double mu = std::log(std::max(1e-4f, mean_on_hit)) - 0.5 * sigma * sigma;
+	const double lc = std::log(double(max_x));
+	const double tail = 1.0 - NormalCdf((lc - mu) / sigma);
+	m1 = std::exp(mu + 0.5 * sigma * sigma) * NormalCdf((lc - mu - sigma * sigma) / sigma) + max_x * tail;
+	m2 = std::exp(2.0 * mu + 2.0 * sigma * sigma) * NormalCdf((lc - mu - 2.0 * sigma * sigma) / sigma) + double(max_x) * max_x * tail;
+}
+
+// bankroll change of one spin: -bet * cost, plus bet * payout on a hit, plus each
+// feature's independent round payout
+inline SpinMoments SpinIncrementMoments(const Game& g, double bet, double cost_mult, const ExtraProcess& x) {
+	const double h = std::clamp(g.hit_rate, 0.0f, 1.0f);
+	double m1, m2;
+	CappedPayoutMoments(BaseMeanOnHit(g), g.volatility, g.max_win_x, m1, m2);
+	double mean = h * m1 - cost_mult, var = h * m2 - h * h * m1 * m1;
+	for (int j = 0; j < x.Count(); ++j) {
+		x.Moments(j, m1, m2);
+		mean += x.hit[j] * m1;
+		var += x.hit[j] * m2 - x.hit[j] * x.hit[j] * m1 * m1;
+	}
+	SpinMoments s;
+	s.mean = bet * mean;
+	s.var = bet * bet * var;
+	return s;
+}
+
+// uniforms from the thread's RNG()
+struct StdExtraSource {
+	double Uniform() { return (double(RNG()()) + 0.5) * (1.0 / 4294967296.0); }
+};
+
+class ExtraBatch {
+public:
+	static constexpr int kSpins = 64;
+
+	// start of a trial; src is anything with Uniform() on (0, 1)
+	template<class Src>
+	void Reset(const ExtraProcess& x, Src& src) {
+		next_.resize(x.hit.size());
+		for (int j = 0; j < x.Count(); ++j) next_[j] = Gap(x.hit[j], src);
+		pos_ = kSpins;
+	}
+	// summed payout multiple of all features on the next spin
+	template<class Src>
+	float Next(const ExtraProcess& x, Src& src) {
+		if (pos_ == kSpins) Fill(x, src);
+		return pay_[pos_++];
+	}
+
+private:
+	float pay_[kSpins];
+	std::vector<int> next_; // per feature: spin of its next hit, relative to the batch
+	int pos_ = kSpins;
+
+	// failures before the next hit, by inverse transform
+	template<class Src>
+	static int Gap(float h, Src& src) {
+		if (h >= 1.f) return 0;
+		return int(std::min(1e9, std::floor(std::log(src.Uniform()) / std::log1p(-double(h)))));
+	}
+
+	template<class Src>
+	void Fill(const ExtraProcess& x, Src& src) {
+		std::fill(pay_, pay_ + kSpins, 0.f);
+		for (int j = 0; j < x.Count(); ++j) {
+			int s = next_[j];
+			for (; s < kSpins; s += 1 + Gap(x.hit[j], src)) pay_[s] += x.Draw(j, src.Uniform());
+			next_[j] = s - kSpins;
+		}
+		pos_ = 0;
+	}
+};
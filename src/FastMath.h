@@ -0,0 +1,120 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+// Polynomial exp, log and normal quantile for payout sampling. No branches or table
+// lookups in the Fast / Faster kernels (range reduction is bit arithmetic, regions are
+// selects), so loops over arrays of them vectorize. Tiers:
+//   Exact  - std:: functions, the reference
+//   Fast   - float-accurate: exp, log and quantile within a few 1e-7
+//   Faster - shorter polynomials: exp ~6e-5, log ~1e-6, payout quantiles ~3e-5
+// --check-fastmath measures the kernels and the bias they put into payout means and tails.
+//
+// The kernels are force-inlined and LognormalFromUniform runs in fixed blocks of 8:
+// GCC's -O2 cost model only vectorizes loops that need no remainder or alias checks, and
+// it won't inline InvNormalLower on its own there.
+
+enum class MathTier { Exact, Fast, Faster };
+
+inline const char* MathTierName(MathTier t) { return t == MathTier::Fast ? "fast" : t == MathTier::Faster ? "faster" : "exact"; }
+
+#if defined(_MSC_VER)
+#define SP_KERNEL __forceinline
+#else
+#define SP_KERNEL inline __attribute__((always_inline))
+#endif
+
+namespace fastmath {
+
+// |x| < 87; no clamp, which would keep the loop from vectorizing (payout exponents stay
+// within +-40)
+template<MathTier T>
+SP_KERNEL float Exp(float x) {
+	if constexpr (T == MathTier::Exact) return std::exp(x);
+	else {
+		const float n = (x * 1.44269504f + 12582912.f) - 12582912.f; // round to nearest: 1.5 * 2^23 drops the fraction
+		const int32_t ni = int32_t(n);
+		const float r = (x - n * 0.693145752f) - n * 1.42860677e-6f; // ln 2 in two parts, |r| <= ln2 / 2
+		float p;
+		if constexpr (T == MathTier::Fast) p = 1.f + r * (1.f + r * (0.5f + r * (1.f / 6 + r * (1.f / 24 + r * (1.f / 120 + r * (1.f / 720))))));
+		else p = 1.f + r * (1.f + r * (0.5f + r * (1.f / 6 + r * (1.f / 24))));
+		return p * std::bit_cast<float>(uint32_t(ni + 127) << 23);
+	}
+}
+
+// x > 0 and normal
+template<MathTier T>
+SP_KERNEL float Log(float x) {
+	if constexpr (T == MathTier::Exact) return std::log(x);
+	else {
+		// x = 2^e m with m in [sqrt(1/2), sqrt(2)): offsetting by sqrt(1/2)'s bits moves the
+		// exponent boundary there
+		const int32_t k = int32_t(std::bit_cast<uint32_t>(x) - 0x3f3504f3u);
+		const float e = float(k >> 23);
+		const float m = std::bit_cast<float>(uint32_t(k & 0x7fffff) + 0x3f3504f3u);
+		// log m = 2 atanh(s), |s| <= 0.172
+		const float s = (m - 1.f) / (m + 1.f), z = s * s;
+		float p;
+		if constexpr (T == MathTier::Fast) p = 1.f + z * (1.f / 3 + z * (1.f / 5 + z * (1.f / 7 + z * (1.f / 9))));
+		else p = 1.f + z * (1.f / 3 + z * (1.f / 5));
+		return e * 0.693147181f + 2.f * s * p;
+	}
+}
+
+// y > 0 and normal; reciprocal square root from the exponent trick plus Newton steps,
+// since std::sqrt's errno path keeps GCC from vectorizing
+template<MathTier T>
+SP_KERNEL float Sqrt(float y) {
+	if constexpr (T == MathTier::Exact) return std::sqrt(y);
+	else {
+		float r = std::bit_cast<float>(0x5f375a86u - (std::bit_cast<uint32_t>(y) >> 1)); // ~3e-3
+		r = r * (1.5f - 0.5f * y * r * r); // ~1e-5
+		r = r * (1.5f - 0.5f * y * r * r); // ~1e-10, float-accurate
+		if constexpr (T == MathTier::Fast) r = r * (1.5f - 0.5f * y * r * r);
+		return y * r;
+	}
+}
+
+// standard normal quantile of q in (0, 0.5], i.e. <= 0. Wichura's PPND7 (AS 241, ~1e-7):
+// made for single precision, where Acklam's central form cancels to ~1e-4 near its edge.
+// Its three regions share one cubic / cubic shape, so the region only selects the
+// argument and coefficients: one log, one sqrt and one division per draw.
+template<MathTier T>
+SP_KERNEL float InvNormalLower(float q) {
+	const float c = q - 0.5f;
+	const float t = Sqrt<T>(-Log<T>(q));
+	// regions as 0/1 weights blending arguments and coefficients: GCC won't if-convert
+	// (and so won't vectorize) nested selects while FP traps are on
+	const float wm = c >= -0.425f ? 1.f : 0.f, wn = t <= 5.f ? 1.f : 0.f;
+	auto pick = [&](float m, float n, float f) { const float tail = f + wn * (n - f); return tail + wm * (m - tail); };
+	const float x = pick(0.180625f - c * c, t - 1.6f, t - 5.f);
+	const float num = ((pick(59.109374720f, 0.17023821103f, 0.017337203997f) * x + pick(159.29113202f, 1.3067284816f, 0.42868294337f)) * x
+		+ pick(50.434271938f, 2.7568153900f, 3.0812263860f)) * x + pick(3.3871327179f, 1.4234372777f, 6.6579051150f);
+	const float den = ((pick(67.187563600f, 0.f, 0.f) * x + pick(78.757757664f, 0.12021132975f, 0.012258202635f)) * x
+		+ pick(17.895169469f, 0.73700164250f, 0.24197894225f)) * x + 1.f;
+	return pick(c, -1.f, -1.f) * num / den;
+}
+
+// n lognormal(mu, sigma) draws capped at max_x, n a multiple of kBlock. Uniform u enters
+// as q = min(u, 1 - u), taken in double by the caller so the upper tail keeps its
+// resolution, and sign = +1 when u > 0.5, else -1.
+constexpr int kBlock = 8;
+
+template<MathTier T>
+inline void LognormalFromUniform(const float* __restrict q, const float* __restrict sign, float* __restrict out, int n, float mu, float sigma, float max_x) {
+	for (int i = 0; i < n; i += kBlock)
+		for (int k = i; k < i + kBlock; ++k)
+			out[k] = std::min(max_x, Exp<T>(mu - sigma * sign[k] * InvNormalLower<T>(q[k])));
+}
+
+inline void LognormalFromUniform(MathTier t, const float* q, const float* sign, float* out, int n, float mu, float sigma, float max_x) {
+	switch (t) {
+	case MathTier::Fast: LognormalFromUniform<MathTier::Fast>(q, sign, out, n, mu, sigma, max_x); break;
+	case MathTier::Faster: LognormalFromUniform<MathTier::Faster>(q, sign, out, n, mu, sigma, max_x); break;
+	default: LognormalFromUniform<MathTier::Exact>(q, sign, out, n, mu, sigma, max_x); break;
+	}
+}
+
+}
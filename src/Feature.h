@@ -0,0 +1,88 @@
+#pragma once
+#include "Models.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Free-spin rounds as a precomputed distribution. A round is `spins` free spins at the
+// game's hit rate and volatility; each spin may retrigger another `spins` with the win
+// multiplier up by one. Simulating that per trigger would cost a whole inner session, so
+// BuildFeatureTable runs kRounds rounds once, sorts their totals and keeps the mean of
+// each of kEntries equal-probability strata, normalized to mean 1. Drawing a round is
+// then one table read scaled to the round's mean payout. Stratum means keep the mean
+// exact; the spread inside a stratum is lost, which only shows in the top one.
+
+struct FeatureSpec {
+	int spins = 10;
+	float hit_rate = 0.25f, volatility = 0.6f;
+};
+
+struct FeatureTable {
+	static constexpr int kEntries = 1024;
+	static constexpr int kRounds = 1 << 14;
+	static constexpr float kRetrigger = 0.02f; // per free spin
+	static constexpr int kMaxRetriggers = 4;
+
+	float x[kEntries]; // ascending, mean 1
+
+	float Sample(double u) const { return x[std::min(kEntries - 1, int(u * kEntries))]; }
+};
+
+inline uint64_t FeatureKey(const FeatureSpec& s) { return hashing::Mix(hashing::Mix(hashing::Mix(0, s.spins), s.hit_rate), s.volatility); }
+
+inline void BuildFeatureTable(const FeatureSpec& spec, FeatureTable& t) {
+	SP_PROFILE_SCOPE("BuildFeatureTable");
+	std::mt19937_64 rng(FeatureKey(spec)); // same spec, same table
+	const float h = std::clamp(spec.hit_rate, 0.001f, 1.f);
+	const float sigma = 0.5f + 1.5f * std::clamp(spec.volatility, 0.0f, 1.0f);
+	std::lognormal_distribution<float> pay(std::log(1.f / h) - 0.5f * sigma * sigma, sigma);
+	std::uniform_real_distribution<float> u(0.f, 1.f);
+
+	std::vector<float> total(FeatureTable::kRounds);
+	for (float& tot : total) {
+		int left = std::max(1, spec.spins), retriggers = 0;
+		float mult = 1.f;
+		tot = 0.f;
+		while (left-- > 0) {
+			if (u(rng) < h) tot += mult * pay(rng);
+			if (retriggers < FeatureTable::kMaxRetriggers && u(rng) < FeatureTable::kRetrigger) { left += spec.spins; mult += 1.f; ++retriggers; }
+		}
+	}
+	std::sort(total.begin(), total.end());
+	constexpr int per = FeatureTable::kRounds / FeatureTable::kEntries;
+	double sum = 0.0;
+	for (int i = 0; i < FeatureTable::kEntries; ++i) {
+		double s = 0.0;
+		for (int k = 0; k < per; ++k) s += total[size_t(i) * per + k];
+		t.x[i] = float(s / per);
+		sum += s;
+	}
+	const float norm = sum > 0.0 ? float(FeatureTable::kRounds / sum) : 0.f;
+	for (float& v : t.x) v *= norm;
+}
+
+// Tables by spec: built on first use, shared by every game and extra with the same round
+// shape. Bounded so slider drags on the game stats don't grow it without end. The build
+// runs outside the lock so ranking threads on other specs don't queue behind it; two
+// threads missing on the same spec both build and the first insert wins.
+inline std::shared_ptr<const FeatureTable> FeatureTableFor(const FeatureSpec& spec) {
+	static std::mutex m;
+	static std::unordered_map<uint64_t, std::shared_ptr<const FeatureTable>> cache;
+	constexpr size_t kMaxTables = 256;
+	const uint64_t key = FeatureKey(spec);
+	{
+		std::lock_guard<std::mutex> lk(m);
+		auto it = cache.find(key);
+		if (it != cache.end()) return it->second;
+	}
+	auto t = std::make_shared<FeatureTable>();
+	BuildFeatureTable(spec, *t);
+	std::lock_guard<std::mutex> lk(m);
+	if (cache.size() >= kMaxTables) cache.clear(); // runs in flight keep theirs alive
+	return cache.emplace(key, std::move(t)).first->second;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "Compare.h"
+#include <cmath>
+#include <cstdint>
+
+// Session accounting in integer minor units. Bankroll, spin cost and thresholds are
+// int64 millicents, so a trial's balance carries no rounding drift however long it runs.
+// Trials draw from TrialRng(seed, t) with the same two uniforms per spin as RunCrnTrial,
+// so a seed reproduces every trial bit for bit on one build; the payout multiples still
+// go through the platform's exp and log, and another compiler's last-bit difference can
+// move a payout across a cent. The payout math tier is ignored for the same reason.
+//
+// Stakes and spin costs (stake times cost_mult with extras on) are whole cents, at least
+// one, like a real bet, and every payout is rounded down to the cent, the way casinos
+// settle fractional wins. That rounding is real money: on stakes of a few cents it takes
+// a visible bite out of the RTP that the float engine doesn't see, and a planned bet
+// under half a cent is placed at twice or more its size.
+// CentRounding says how far off a plan is; --check-fixed and the UI show it.
+
+namespace money {
+using Minor = int64_t;
+constexpr Minor kPerUnit = 100000; // millicents per currency unit
+constexpr Minor kCent = 1000;
+
+inline Minor FromUnits(double v) { return Minor(std::llround(v * kPerUnit)); }
+inline double ToUnits(Minor m) { return double(m) / kPerUnit; }
+// a placed stake: nearest whole cent, never below one
+inline Minor Stake(double v) { return std::max(kCent, Minor(std::llround(v * 100.0)) * kCent); }
+// what a spin costs: the stake plus extras priced off it, to the nearest whole cent
+inline Minor SpinCost(Minor stake, float cost_mult) { return std::max(kCent, Minor(std::llround(double(stake) * cost_mult / kCent)) * kCent); }
+// what the game pays for mult x stake, cut down to whole cents
+inline Minor Payout(Minor stake, float mult) { return Minor(double(stake) * mult / kCent) * kCent; }
+}
+
+// what placing bet in whole cents does to a plan
+struct CentRounding {
+	float stake_ratio = 1.f; // placed stake / planned bet
+	float rtp_loss = 0.f;    // RTP lost per spin to flooring payouts, about half a cent a hit
+	bool Distorted() const { return std::abs(stake_ratio - 1.f) > 0.1f || rtp_loss > 0.01f; }
+};
+
+inline CentRounding CentRoundingFor(const Game& g, float bet) {
+	CentRounding c;
+	const double stake = money::ToUnits(money::Stake(bet));
+	c.stake_ratio = bet > 0.f ? float(stake / bet) : 1.f;
+	c.rtp_loss = float(std::clamp(g.hit_rate, 0.f, 1.f) * 0.005 / stake);
+	return c;
+}
+
+struct FixedSetup {
+	money::Minor start = 0, take_profit = 0, stop_loss = 0;
+};
+
+inline FixedSetup PrepareFixed(const SessionInput& in, const SessionSetup& su) {
+	FixedSetup f;
+	f.start = money::FromUnits(in.start_bankroll);
+	f.take_profit = money::FromUnits(su.plan.take_profit);
+	f.stop_loss = money::FromUnits(su.plan.stop_loss);
+	return f;
+}
+
+// SimulateSessionTrialsWith with an integer bankroll, trial t on TrialRng(seed, t). Each
+// spin places strat's stake in whole cents.
+template<class Strategy>
+inline void SimulateSessionTrialsFixedWith(const Game& g, const SessionSetup& su, const FixedSetup& f, const Strategy& strat, int t0, int t1, SessionTally& tally, uint64_t seed) {
+	const int spins = su.plan.planned_spins;
+	const bool extras = su.extras.Count() > 0;
+	const float mean_on_hit = BaseMeanOnHit(g);
+	ExtraBatch batch;
+
+	int hit_tp = 0, ruin = 0;
+	money::Minor end_sum = 0; // exact; 2^63 millicents is ~9e13 units
+	uint64_t n_spins = 0, n_hits = 0;
+	for (int t = t0; t < t1; ++t) {
+		TrialRng rng(seed, t), xsrc = rng.Fork(0xe7a5);
+		Strategy policy = strat;
+		money::Minor bank = f.start, bet = 0, cost = 0;
+		float placed = -1.f; // the want bet and cost were rounded from; flat bets round once
+		if (extras) batch.Reset(su.extras, xsrc);
+		for (int s = 0; s < spins; ++s) {
+			const float want = policy.Bet(money::ToUnits(bank), su.cost_mult);
+			if (want <= 0.f) break;
+			if (want != placed) { placed = want; bet = money::Stake(want); cost = money::SpinCost(bet, su.cost_mult); }
+			if (bank < cost) break;
+			const double u_hit = rng.Uniform(), u_pay = rng.Uniform(); // as RunCrnTrial
+			bank -= cost;
+			++n_spins;
+			money::Minor won = 0;
+			if (u_hit < g.hit_rate) {
+				++n_hits;
+				won = money::Payout(bet, PayoutFromUniform(mean_on_hit, g.volatility, g.max_win_x, u_pay));
+			}
+			if (extras) won += money::Payout(bet, batch.Next(su.extras, xsrc));
+			bank += won;
+			policy.Settle(won > cost);
+			if (bank >= f.take_profit) { ++hit_tp; break; }
+			if (bank <= f.stop_loss) { ++ruin; break; }
+		}
+		end_sum += bank;
+	}
+	SP_COUNT(Spins, n_spins);
+	SP_COUNT(Hits, n_hits);
+	tally.trials += t1 - t0;
+	tally.hit_tp += hit_tp; tally.ruin += ruin; tally.end_sum += money::ToUnits(end_sum);
+}
+
+inline void SimulateSessionTrialsFixed(const Game& g, const SessionInput& in, const SessionSetup& su, int t0, int t1, SessionTally& tally, uint64_t seed = 0x5107) {
+	const FixedSetup f = PrepareFixed(in, su);
+	VisitStrategy(su.strategy, [&](const auto& strat) { SimulateSessionTrialsFixedWith(g, su, f, strat, t0, t1, tally, seed); });
+}
+
+inline SimResult SimulateSessionFixed(const Game& g, const SessionInput& in) {
+	SP_PROFILE_SCOPE("SimulateSessionFixed");
+	SessionSetup su = PrepareSession(g, in);
+	SessionTally tally;
+	SimulateSessionTrialsFixed(g, in, su, 0, su.trials, tally);
+	SimResult r = SessionResult(su, tally);
+	r.recommended_bet = float(money::ToUnits(money::Stake(r.recommended_bet)));
+	return r;
+}
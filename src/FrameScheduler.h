@@ -0,0 +1,74 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+// Decides when the main loop has to render. An idle planner blocks until input arrives or
+// a background job calls Wake(); input buys a short burst of frames so ImGui can settle
+// hover/nav state, and ongoing work (progress bars, text cursor) ticks at a low rate.
+// Backend-free: Win32 blocks in MsgWaitForMultipleObjects, headless loops use Wait().
+class FrameScheduler {
+public:
+	using Clock = std::chrono::steady_clock;
+	static constexpr int kBurstFrames = 6;
+	static constexpr int kActiveIntervalMs = 100;
+
+	void OnInput() { burst_ = kBurstFrames; }
+
+	// any thread; wakes a blocked loop for one frame
+	void Wake() {
+		{ std::lock_guard<std::mutex> lk(m_); woken_ = true; }
+		cv_.notify_all();
+		if (wake_hook_) wake_hook_();
+	}
+	void SetWakeHook(std::function<void()> hook) { wake_hook_ = std::move(hook); }
+
+	// UI-thread work is sliced across frames: draw the next one without waiting
+	void RequestFrame() { woken_ = true; }
+
+	// app has visible work in flight; re-evaluated every frame
+	void SetActive(bool active) { active_ = active; }
+
+	bool NeedsFrame() const {
+		return burst_ > 0 || woken_ || (active_ && Clock::now() >= next_tick_);
+	}
+
+	// milliseconds the loop may block before the next frame is due; -1 = until woken
+	int IdleTimeoutMs() const {
+		if (NeedsFrame()) return 0;
+		if (!active_) return -1;
+		auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(next_tick_ - Clock::now()).count();
+		return (int)std::max<long long>(0, ms);
+	}
+
+	// call before drawing so a Wake() that lands mid-frame still gets its own frame
+	void BeginFrame() { woken_ = false; }
+
+	void FrameDone() {
+		if (burst_ > 0) --burst_;
+		next_tick_ = Clock::now() + std::chrono::milliseconds(kActiveIntervalMs);
+		++frames_;
+	}
+
+	// headless: block until Wake() or timeout
+	void Wait(int timeout_ms) {
+		std::unique_lock<std::mutex> lk(m_);
+		if (timeout_ms < 0) cv_.wait(lk, [&] { return woken_.load(); });
+		else cv_.wait_for(lk, std::chrono::milliseconds(timeout_ms), [&] { return woken_.load(); });
+	}
+
+	long long Frames() const { return frames_; }
+
+private:
+	int burst_ = kBurstFrames; // draw the first frames unconditionally
+	bool active_ = false;
+	std::atomic<bool> woken_{ false };
+	Clock::time_point next_tick_{};
+	long long frames_ = 0;
+	std::mutex m_;
+	std::condition_variable cv_;
+	std::function<void()> wake_hook_;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// splitmix64 and what is built on it: per-trial random streams and the fingerprints that
+// key cached inputs (deps keys, feature tables).
+namespace hashing {
+
+inline uint64_t Finalize(uint64_t z) {
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+// splitmix64 finalizer over the running hash
+inline uint64_t Mix(uint64_t h, uint64_t v) { return Finalize(h ^ (v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2))); }
+inline uint64_t Mix(uint64_t h, float f) { uint32_t u; std::memcpy(&u, &f, sizeof(u)); return Mix(h, uint64_t(u)); }
+inline uint64_t Mix(uint64_t h, int i) { return Mix(h, uint64_t(uint32_t(i))); }
+inline uint64_t Mix(uint64_t h, bool b) { return Mix(h, uint64_t(b)); }
+}
+
+// splitmix64 keyed by (seed, trial): any trial can be replayed on any thread. The start
+// state is hashed, plain seed + trial * gamma would make trial t+1 replay trial t shifted
+// by one draw.
+struct TrialRng {
+	uint64_t s;
+	TrialRng(uint64_t seed, int trial) : s(Mix(Mix(seed) + uint64_t(uint32_t(trial)))) {}
+	static uint64_t Mix(uint64_t z) { return hashing::Finalize(z); }
+	uint64_t Next() { return Mix(s += 0x9e3779b97f4a7c15ull); }
+	// independent stream for the same trial, e.g. for draws that must not shift the main one
+	TrialRng Fork(uint64_t salt) const { TrialRng r = *this; r.s = Mix(s ^ salt); return r; }
+	// (0, 1), never exactly 0 or 1
+	double Uniform() { return (double(Next() >> 11) + 0.5) * (1.0 / 9007199254740992.0); }
+};
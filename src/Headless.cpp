@@ -0,0 +1,184 @@
+#include "Headless.h"
+#include "App.h"
+#include "FrameScheduler.h"
+#include <imgui_internal.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#ifdef USE_IMPLOT
+#include "implot.h"
+#endif
+
+namespace {
+size_t g_allocs = 0, g_alloc_bytes = 0;
+void* CountingAlloc(size_t sz, void*) { ++g_allocs; g_alloc_bytes += sz; return std::malloc(sz); }
+void CountingFree(void* p, void*) { std::free(p); }
+
+using Clock = std::chrono::steady_clock;
+double MsSince(Clock::time_point t0) { return std::chrono::duration<double, std::milli>(Clock::now() - t0).count(); }
+
+struct BenchResult {
+	int ticks = 0, rendered = 0;
+	double setup_ms = 0.0, first_ms = 0.0;
+	std::vector<double> ms;
+	std::vector<int> vtx, idx;
+	std::vector<size_t> allocs, alloc_bytes;
+};
+
+template<class T> double Mean(const std::vector<T>& v) {
+	double s = 0; for (auto x : v) s += double(x);
+	return v.empty() ? 0.0 : s / v.size();
+}
+double Pct(std::vector<double> v, double p) {
+	if (v.empty()) return 0.0;
+	std::sort(v.begin(), v.end());
+	return v[std::min(v.size() - 1, size_t(p * (v.size() - 1) + 0.5))];
+}
+}
+
+// Script callback: inject input for this tick, return true if anything was injected.
+using BenchScript = std::function<bool(int tick, ImGuiIO& io, SlotPlannerApp& app)>;
+
+class HeadlessBench {
+public:
+	explicit HeadlessBench(const UiBenchOptions& o) : opts_(o) {}
+
+	int Run() {
+		const bool all = opts_.scenario == "all";
+		bool any = false;
+		std::printf("%-8s %6s %8s %9s %9s %8s %8s %8s %7s %7s %10s %10s\n", "scenario", "ticks", "rendered", "setup_ms", "first_ms",
+			"avg_ms", "p95_ms", "max_ms", "vtx", "idx", "allocs/fr", "KB/fr");
+		if (all || opts_.scenario == "idle") { any = true; Idle(); }
+		if (all || opts_.scenario == "band") { any = true; Band(); }
+		if (all || opts_.scenario == "catalog") { any = true; Catalog(); }
+		if (!any) { std::fprintf(stderr, "unknown scenario '%s' (idle | band | catalog | all)\n", opts_.scenario.c_str()); return 1; }
+		return 0;
+	}
+
+private:
+	UiBenchOptions opts_;
+
+	// no input after the first frames: shows what the frame scheduler skips
+	void Idle() {
+		Report("idle", Drive([](SlotPlannerApp&) {}, [](int, ImGuiIO&, SlotPlannerApp&) { return false; }));
+	}
+
+	// every-spin band over a 5000-spin session, mouse sweeping across the chart
+	void Band() {
+		auto setup = [](SlotPlannerApp& app) {
+			app.input_.max_spins_cap = 5000;
+			app.input_.start_bankroll = 1000.f;
+			app.band_res_.points = 0;
+			app.has_result_ = true;
+			app.UpdateDeps(true);
+			while (app.Simulating()) app.PumpJobs(1000.0); // measure the plot, not the sliced simulation
+		};
+		Report("band", Drive(setup, [](int tick, ImGuiIO& io, SlotPlannerApp&) {
+			io.AddMousePosEvent(600.f + float(tick % 600), 420.f);
+			return true;
+		}));
+	}
+
+	// 50k games: open the Game combo, type a filter, then scroll the list
+	void Catalog() {
+		auto setup = [this](SlotPlannerApp& app) {
+			if (!opts_.catalog.empty()) { app.OpenCatalog(opts_.catalog); return; }
+			std::vector<Game> games(50000);
+			for (int i = 0; i < (int)games.size(); ++i) {
+				char name[32]; std::snprintf(name, sizeof(name), "Game %05d", i);
+				games[i] = { name, 0.94f + 0.0001f * (i % 300), 0.1f + 0.01f * (i % 40), 0.1f + 0.02f * (i % 45), 5000.f, {} };
+				if (i % 3 == 0) games[i].extras = { { "Xbet", 0.96f, 0.4f, false }, { "Bonus Buy (100x)", 0.96f, 100.f, false } };
+			}
+			app.catalog_.Assign(games);
+			app.game_matches_dirty_ = true;
+		};
+		ImVec2 combo{};
+		Report("catalog", Drive(setup, [&combo](int tick, ImGuiIO& io, SlotPlannerApp&) {
+			if (tick == 1) combo = FirstItemIn("Setup");
+			if (tick == 1) { io.AddMousePosEvent(combo.x, combo.y); io.AddMouseButtonEvent(0, true); }
+			else if (tick == 2) io.AddMouseButtonEvent(0, false);
+			else if (tick == 3) io.AddInputCharacter('1');
+			else if (tick == 4) io.AddInputCharacter('2');
+			else if (tick > 4) { io.AddMousePosEvent(combo.x, combo.y + 200.f); io.AddMouseWheelEvent(0.f, tick % 40 < 20 ? -1.f : 1.f); }
+			return tick > 0;
+		}));
+	}
+
+	// first item of a card: its content origin plus a little inset
+	static ImVec2 FirstItemIn(const char* card) {
+		char tag[64]; std::snprintf(tag, sizeof(tag), "/%s_", card);
+		for (ImGuiWindow* w : GImGui->Windows)
+			if (std::strstr(w->Name, tag)) return { w->ContentRegionRect.Min.x + 40.f, w->ContentRegionRect.Min.y + 10.f };
+		return { 0.f, 0.f };
+	}
+
+	BenchResult Drive(const std::function<void(SlotPlannerApp&)>& setup, const BenchScript& script) {
+		ImGui::SetAllocatorFunctions(CountingAlloc, CountingFree);
+		ImGui::CreateContext();
+#ifdef USE_IMPLOT
+		ImPlot::CreateContext();
+#endif
+		ApplyPrettyStyle();
+		ImGuiIO& io = ImGui::GetIO();
+		io.DisplaySize = { 1280.f, 800.f };
+		io.DeltaTime = 1.f / 60.f;
+		io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+		unsigned char* px; int tw, th;
+		io.Fonts->GetTexDataAsRGBA32(&px, &tw, &th); // null renderer: build the atlas, never upload it
+
+		BenchResult res;
+		{
+			FrameScheduler sched;
+			SlotPlannerApp app;
+			auto t0 = Clock::now();
+			setup(app);
+			res.setup_ms = MsSince(t0);
+
+			for (int tick = 0; tick < opts_.frames; ++tick) {
+				++res.ticks;
+				if (script(tick, io, app)) sched.OnInput();
+				if (!sched.NeedsFrame()) continue;
+				sched.BeginFrame();
+
+				size_t a0 = g_allocs, b0 = g_alloc_bytes;
+				auto f0 = Clock::now();
+				ImGui::NewFrame();
+				app.Draw();
+				ImGui::Render();
+				double ms = MsSince(f0);
+
+				ImDrawData* dd = ImGui::GetDrawData();
+				if (res.rendered++ == 0) res.first_ms = ms;
+				else {
+					res.ms.push_back(ms);
+					res.vtx.push_back(dd->TotalVtxCount);
+					res.idx.push_back(dd->TotalIdxCount);
+					res.allocs.push_back(g_allocs - a0);
+					res.alloc_bytes.push_back(g_alloc_bytes - b0);
+				}
+				sched.SetActive(app.Busy() || io.WantTextInput);
+				if (app.Simulating()) sched.RequestFrame();
+				sched.FrameDone();
+			}
+		}
+#ifdef USE_IMPLOT
+		ImPlot::DestroyContext();
+#endif
+		ImGui::DestroyContext();
+		return res;
+	}
+
+	static void Report(const char* name, const BenchResult& r) {
+		double max_ms = r.ms.empty() ? 0.0 : *std::max_element(r.ms.begin(), r.ms.end());
+		std::printf("%-8s %6d %8d %9.2f %9.2f %8.3f %8.3f %8.3f %7.0f %7.0f %10.1f %10.1f\n", name, r.ticks, r.rendered, r.setup_ms, r.first_ms,
+			Mean(r.ms), Pct(r.ms, 0.95), max_ms, Mean(r.vtx), Mean(r.idx), Mean(r.allocs), Mean(r.alloc_bytes) / 1024.0);
+	}
+};
+
+int RunUiBench(const UiBenchOptions& opts) {
+	return HeadlessBench(opts).Run();
+}
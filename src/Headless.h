@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+
+struct UiBenchOptions {
+    std::string scenario = "all"; // idle | band | catalog | all
+    int frames = 300;
+    std::string catalog;          // catalog scenario: real catalog instead of 50k synthetic games
+};
+
+// Drives SlotPlannerApp::Draw with a null renderer and scripted input, printing CPU time,
+// vertex/index counts and ImGui allocations per frame. Needs no window or GPU.
+int RunUiBench(const UiBenchOptions& opts);
@@ -0,0 +1,362 @@
+#pragma once
+#include "Compare.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Multilevel Monte Carlo over spin resolution, for long sessions (240 minutes at 30 spins
+// a minute is 7200 spins a trial). A spin splits into a light-tailed body and jumps: base
+// hits in the top jump_share of payouts and every feature round, which arrive with
+// geometric gaps (like ExtraBatch) and are drawn exactly on every level. Level l < L
+// replaces the body with a Gaussian random walk of the body's exact mean and variance in
+// blocks of R^(L-l) spins, stop-loss and take-profit checked at block ends; the top level
+// L is the real session, spin by spin. The estimate
+//   E[P_L] = E[P_0] + sum over l of E[P_l - P_l-1]
+// takes its bulk from many cheap level-0 paths and only corrections from the finer ones.
+// Each correction runs a fine and a coarse path on shared randomness so the difference is
+// small: both see the same jumps, a coarse block's body is the sum of its R fine blocks',
+// and at the top every real spin's body is mapped to the normal quantile of its place in
+// the body's law (exactly uniform, the no-hit atom spread by the hit draw). Every coarse
+// path is then distributed exactly as the level below's fine one, so the Gaussian levels
+// only set how much the corrections cost, never the answer. Keeping the jumps out of the
+// Gaussian keeps the corrections from hinging on the rare bonus round only the fine path
+// has. Bets are flat at the plan's stake: a block's Gaussian needs one fixed stake, so
+// in.strategy is ignored here.
+//
+// Trials per level come from a pilot: N_l ~ sqrt(V_l / C_l) minimizes the work for a
+// target standard error, V_l being the correction's variance and C_l its steps per sample.
+// The pilot also prices plain Monte Carlo (the real level's fine paths alone, at their own
+// variance); when that is cheaper, as on low-risk games where few trials are needed,
+// the estimate is plain Monte Carlo on those paths instead.
+
+enum class MlmcMethod { Auto, Multilevel, Plain };
+
+struct MlmcOptions {
+	MlmcMethod method = MlmcMethod::Auto; // Auto: whichever the pilot prices cheaper
+	float tol_prob = 0.005f;   // standard error target for ruin and take-profit odds
+	float tol_end = 0.005f;    // ... for the expected end, as a share of the starting bankroll
+	float jump_share = 0.01f;  // base hits paying in this top share are jumps
+	int levels = 0;            // Gaussian levels; 0: coarsest block up to spins / 16
+	int refine = 4;            // R, block growth per level
+	int pilot = 400;           // samples per level for the variance and cost estimates
+	uint64_t seed = 0x3a1c;
+	int threads = 0;
+};
+
+struct MlmcLevel {
+	int block = 1;                    // spins per step of the fine path; 1: the real session
+	int samples = 0;
+	double cost = 0.0;                // steps simulated per sample, both paths
+	double mean[3] = {}, var[3] = {}; // of P_l - P_l-1: ruin, take-profit, end
+};
+
+struct MlmcResult {
+	SimResult result;
+	bool multilevel = true;        // false: plain Monte Carlo on the real level
+	float se_ruin = 0.f, se_hit_target = 0.f, se_end = 0.f;
+	std::vector<MlmcLevel> levels; // coarsest first
+	double steps = 0.0;            // total work
+	double real_var[3] = {};       // one real session's variance: ruin, take-profit, end
+	int mc_trials = 0;             // plain Monte Carlo trials for the same errors
+	double mc_steps = 0.0;         // ... and their spins
+};
+
+namespace mlmc {
+struct Bounds {
+	double bet, bet_total, tp, sl;
+};
+
+// one path's bankroll; done once it stops, like SimulateSessionTrials' spin loop
+struct Walk {
+	double bank = 0.0;
+	bool done = false, ruin = false, hit_tp = false;
+	int steps = 0;
+
+	void Step(const Bounds& b, double inc) {
+		if (done) return;
+		if (bank < b.bet_total) { done = true; return; }
+		bank += inc;
+		++steps;
+		if (bank >= b.tp) hit_tp = done = true;
+		else if (bank <= b.sl) ruin = done = true;
+	}
+	void Out(double* o) const { o[0] = ruin; o[1] = hit_tp; o[2] = bank; }
+};
+
+// the session's spin, in bets, as body and jump laws
+struct SpinModel {
+	const Game* g = nullptr;
+	const ExtraProcess* extras = nullptr;
+	float mean_on_hit = 0.f;
+	double cost = 1.0;
+	double u_jump = 1.0;    // payout quantile where base hits become jumps
+	double p_jump = 0.0;    // per spin
+	double body_hit = 0.0;  // hit rate of a spin that isn't a base jump
+
+	SpinModel(const Game& g_, const SessionSetup& su, float jump_share) : g(&g_), extras(&su.extras), mean_on_hit(BaseMeanOnHit(g_)), cost(su.cost_mult) {
+		const double h = std::clamp(double(g_.hit_rate), 0.0, 1.0);
+		u_jump = 1.0 - std::clamp(double(jump_share), 0.0, 0.5);
+		p_jump = h * (1.0 - u_jump);
+		body_hit = p_jump < 1.0 ? h * u_jump / (1.0 - p_jump) : 0.0;
+	}
+	int Sources() const { return 1 + extras->Count(); }
+	double Rate(int j) const { return j ? extras->hit[j - 1] : p_jump; }
+	double Jump(int j, double u) const {
+		if (j) return extras->Draw(j - 1, u);
+		return PayoutFromUniform(mean_on_hit, g->volatility, g->max_win_x, u_jump + (1.0 - u_jump) * u);
+	}
+	// bankroll change of a spin without a base jump: its cost, and a payout below the jump
+	// line. u is where the spin falls in the body's law: the no-hit atom is [0, 1 - hit)
+	// and hits follow in payout order, so u is uniform and the body increasing in it.
+	template<class Rng>
+	double Body(Rng& rng, double& u) const {
+		const double u_hit = rng.Uniform(), u_pay = rng.Uniform(); // fixed draws per spin keep streams aligned
+		if (u_hit < 1.0 - body_hit) { u = u_hit; return -cost; }
+		u = (1.0 - body_hit) + body_hit * u_pay;
+		return PayoutFromUniform(mean_on_hit, g->volatility, g->max_win_x, u_jump * u_pay) - cost;
+	}
+};
+
+// every jump source's next spin, stepped with geometric gaps; the same law at every level
+struct Jumps {
+	const SpinModel& m;
+	TrialRng rng;
+	std::vector<int> next;
+
+	Jumps(const SpinModel& m_, TrialRng r) : m(m_), rng(r), next(m_.Sources()) {
+		for (int j = 0; j < m.Sources(); ++j) next[j] = Gap(m.Rate(j));
+	}
+	int Gap(double p) {
+		if (p <= 0.0) return 1 << 30;
+		if (p >= 1.0) return 0;
+		return int(std::min(1e9, std::floor(std::log(rng.Uniform()) / std::log1p(-p))));
+	}
+	// payouts of the jumps before spin s1 not taken yet, into pay; returns the base jumps,
+	// each a spin whose cost is in no body
+	int Take(int s1, double& pay) {
+		int base = 0;
+		for (int j = 0; j < m.Sources(); ++j)
+			for (; next[j] < s1; next[j] += 1 + Gap(m.Rate(j))) {
+				pay += m.Jump(j, rng.Uniform());
+				base += j == 0;
+			}
+		return base;
+	}
+};
+
+struct Context {
+	int spins = 0, top = 0, R = 4;
+	double start = 0.0, mu = 0.0, sd = 0.0; // body of one spin, bankroll units
+	Bounds b{};
+};
+
+// the body's mean and deviation by midpoint quadrature over its payout quantiles
+inline void BodyMoments(const SpinModel& m, Context& c) {
+	constexpr int kPoints = 65536;
+	double s = 0.0, s2 = 0.0;
+	for (int i = 0; i < kPoints; ++i) {
+		const double y = PayoutFromUniform(m.mean_on_hit, m.g->volatility, m.g->max_win_x, m.u_jump * (i + 0.5) / kPoints);
+		s += y; s2 += y * y;
+	}
+	const double h = m.body_hit, m1 = s / kPoints, m2 = s2 / kPoints;
+	c.mu = c.b.bet * (h * m1 - m.cost);
+	c.sd = c.b.bet * std::sqrt(std::max(0.0, h * m2 - h * h * m1 * m1));
+}
+
+// one correction sample of level l: fine and coarse outcomes, the steps taken, and the
+// fine path's own steps (what plain Monte Carlo would have paid for it). Without
+// with_coarse only the fine path runs; its draws are the same either way.
+inline double Sample(const SpinModel& m, const Context& c, int l, TrialRng rng, double* fine, double* coarse, int& fine_steps, bool with_coarse = true) {
+	const bool two = l > 0 && with_coarse;
+	Walk f{ c.start }, k{ c.start };
+	Jumps jumps(m, rng.Fork(0x1e4d));
+	const double bet = c.b.bet;
+	double steps = 0.0, acc = 0.0;
+	int in_block = 0;
+	if (l == c.top) {
+		double z = 0.0; // coarse block: normal scores of the body spins' places in their law
+		int body_spins = 0;
+		for (int s = 0; s < c.spins && !(f.done && (!two || k.done)); ++s) {
+			double pay = 0.0;
+			const int base = jumps.Take(s + 1, pay);
+			double u = 0.5;
+			const double b = base ? 0.0 : m.Body(rng, u);
+			const double inc = b + pay - base * m.cost;
+			f.Step(c.b, bet * inc);
+			++steps;
+			if (!two) continue;
+			acc += pay - base * m.cost;
+			if (!base) { z += InvNormalCdf(u); ++body_spins; }
+			if (++in_block == c.R || s + 1 == c.spins) {
+				k.Step(c.b, body_spins * c.mu + c.sd * z + bet * acc);
+				acc = z = 0.0; in_block = body_spins = 0; ++steps;
+			}
+		}
+	}
+	else {
+		int block = 1;
+		for (int i = l; i < c.top; ++i) block *= c.R;
+		for (int s = 0; s < c.spins && !(f.done && (!two || k.done));) {
+			const int n = std::min(block, c.spins - s);
+			double pay = 0.0;
+			const int base = jumps.Take(s + n, pay);
+			const int body_spins = n - base;
+			double inc = bet * (pay - base * m.cost);
+			if (body_spins > 0) inc += body_spins * c.mu + c.sd * std::sqrt(double(body_spins)) * InvNormalCdf(rng.Uniform());
+			f.Step(c.b, inc);
+			s += n; ++steps;
+			if (!two) continue;
+			acc += inc;
+			if (++in_block == c.R || s == c.spins) { k.Step(c.b, acc); acc = 0.0; in_block = 0; }
+		}
+	}
+	f.Out(fine);
+	fine_steps = f.steps;
+	if (two) k.Out(coarse);
+	else coarse[0] = coarse[1] = coarse[2] = 0.0;
+	return steps;
+}
+
+struct Sums {
+	double n = 0.0, steps = 0.0, fine_steps = 0.0;
+	double d[3] = {}, d2[3] = {}, f[3] = {}, f2[3] = {}; // correction and fine path
+	void Add(const Sums& o) {
+		n += o.n; steps += o.steps; fine_steps += o.fine_steps;
+		for (int i = 0; i < 3; ++i) { d[i] += o.d[i]; d2[i] += o.d2[i]; f[i] += o.f[i]; f2[i] += o.f2[i]; }
+	}
+	static double Var(double s, double s2, double n) { return n > 1.0 ? std::max(0.0, (s2 - s * s / n) / (n - 1.0)) : 0.0; }
+};
+
+// samples [i0, i1) of level l, in fixed chunks so the sums don't depend on the thread count
+inline void Run(const SpinModel& m, const Context& c, int l, uint64_t seed, int i0, int i1, Sums& out, int threads, bool with_coarse = true) {
+	constexpr int kChunk = 64;
+	const int chunks = (i1 - i0 + kChunk - 1) / kChunk;
+	std::vector<Sums> part(chunks);
+	TaskPool::ParallelFor(chunks, [&](int ch) {
+		Sums& s = part[ch];
+		double fine[3], coarse[3];
+		int fine_steps = 0;
+		for (int i = i0 + ch * kChunk; i < std::min(i1, i0 + (ch + 1) * kChunk); ++i) {
+			s.steps += Sample(m, c, l, TrialRng(seed, i), fine, coarse, fine_steps, with_coarse);
+			s.fine_steps += fine_steps;
+			s.n += 1.0;
+			for (int k = 0; k < 3; ++k) {
+				const double d = fine[k] - coarse[k];
+				s.d[k] += d; s.d2[k] += d * d; s.f[k] += fine[k]; s.f2[k] += fine[k] * fine[k];
+			}
+		}
+	}, threads);
+	for (const Sums& s : part) out.Add(s);
+}
+}
+
+inline MlmcResult SimulateSessionMlmc(const Game& g, const SessionInput& in, const MlmcOptions& opt = {}) {
+	SP_PROFILE_SCOPE("SimulateSessionMlmc");
+	const SessionSetup su = PrepareSession(g, in);
+	const mlmc::SpinModel model(g, su, opt.jump_share);
+	mlmc::Context c;
+	c.spins = std::max(1, su.plan.planned_spins);
+	c.R = std::max(2, opt.refine);
+	c.top = opt.levels;
+	if (c.top <= 0)
+		for (int b = c.R; b <= c.spins / 16; b *= c.R) ++c.top;
+	c.start = in.start_bankroll;
+	c.b = { su.plan.recommended_bet, double(su.plan.recommended_bet) * su.cost_mult, su.plan.take_profit, su.plan.stop_loss };
+	mlmc::BodyMoments(model, c);
+
+	// per-output tolerances; a level's variance is its worst output's over tol^2
+	const double tol[3] = { opt.tol_prob, opt.tol_prob, opt.tol_end * std::max(1e-3f, in.start_bankroll) };
+	const int L = c.top + 1;
+	std::vector<mlmc::Sums> sums(L);
+	std::vector<uint64_t> seed(L);
+	for (int l = 0; l < L; ++l) seed[l] = hashing::Mix(opt.seed, uint64_t(l + 1));
+	auto worst = [&](const mlmc::Sums& s) {
+		double v = 0.0;
+		for (int i = 0; i < 3; ++i) v = std::max(v, mlmc::Sums::Var(s.d[i], s.d2[i], s.n) / (tol[i] * tol[i]));
+		return v;
+	};
+	// plain Monte Carlo at the same tolerances: the real level's fine paths on their own
+	auto mc_trials = [&] {
+		const mlmc::Sums& real = sums[c.top];
+		double v = 0.0;
+		for (int i = 0; i < 3; ++i) v = std::max(v, mlmc::Sums::Var(real.f[i], real.f2[i], real.n) / (tol[i] * tol[i]));
+		return int(std::min(2e9, std::ceil(v)));
+	};
+	// N_l = sqrt(V_l / C_l) * sum_k sqrt(V_k C_k) with V in units of tol^2; returns the
+	// total work, (sum_k sqrt(V_k C_k))^2
+	std::vector<int> want(L);
+	auto allocate = [&] {
+		double sum_vc = 0.0;
+		for (const auto& s : sums) sum_vc += std::sqrt(worst(s) * s.steps / s.n);
+		for (int l = 0; l < L; ++l) {
+			const double v = worst(sums[l]), cost = std::max(1.0, sums[l].steps / sums[l].n);
+			want[l] = int(std::min(2e9, std::ceil(std::sqrt(v / cost) * sum_vc)));
+		}
+		return sum_vc * sum_vc;
+	};
+
+	const int pilot = std::max(20, opt.pilot);
+	for (int l = 0; l < L; ++l) mlmc::Run(model, c, l, seed[l], 0, pilot, sums[l], opt.threads);
+
+	// variance per cost decides: plain Monte Carlo needs mc_trials() real sessions, and the
+	// pilot's real-level fine paths count towards them. Pilots underrate the corrections'
+	// tails, so near a tie plain Monte Carlo wins.
+	constexpr double kMlmcMargin = 0.8;
+	MlmcResult r;
+	r.multilevel = opt.method == MlmcMethod::Multilevel;
+	if (opt.method == MlmcMethod::Auto) {
+		const mlmc::Sums& real = sums[c.top];
+		r.multilevel = allocate() < kMlmcMargin * mc_trials() * (real.fine_steps / real.n);
+	}
+
+	// heavy tails hide from a pilot, so reallocate on the grown samples until no level asks
+	// for more
+	for (int pass = 0; pass < 4; ++pass) {
+		bool grew = false;
+		if (r.multilevel) {
+			allocate();
+			for (int l = 0; l < L; ++l)
+				if (want[l] > int(sums[l].n)) { mlmc::Run(model, c, l, seed[l], int(sums[l].n), want[l], sums[l], opt.threads); grew = true; }
+		}
+		else if (const int n = mc_trials(); n > int(sums[c.top].n)) {
+			mlmc::Run(model, c, c.top, seed[c.top], int(sums[c.top].n), n, sums[c.top], opt.threads, false);
+			grew = true;
+		}
+		if (!grew) break;
+	}
+
+	r.result = su.plan;
+	double est[3] = {}, se2[3] = {};
+	for (int l = 0; l < L; ++l) {
+		const mlmc::Sums& s = sums[l];
+		MlmcLevel lv;
+		for (int i = l; i < c.top; ++i) lv.block *= c.R;
+		lv.samples = int(s.n);
+		lv.cost = s.steps / s.n;
+		for (int i = 0; i < 3; ++i) {
+			lv.mean[i] = s.d[i] / s.n;
+			lv.var[i] = mlmc::Sums::Var(s.d[i], s.d2[i], s.n);
+			est[i] += lv.mean[i];
+			se2[i] += lv.var[i] / s.n;
+		}
+		r.steps += s.steps;
+		r.levels.push_back(lv);
+	}
+	const mlmc::Sums& real = sums[c.top];
+	if (!r.multilevel)
+		for (int i = 0; i < 3; ++i) {
+			est[i] = real.f[i] / real.n;
+			se2[i] = mlmc::Sums::Var(real.f[i], real.f2[i], real.n) / real.n;
+		}
+	r.result.prob_ruin = float(std::clamp(est[0], 0.0, 1.0));
+	r.result.prob_hit_target = float(std::clamp(est[1], 0.0, 1.0));
+	r.result.expected_end = float(est[2]);
+	r.se_ruin = float(std::sqrt(se2[0]));
+	r.se_hit_target = float(std::sqrt(se2[1]));
+	r.se_end = float(std::sqrt(se2[2]));
+
+	for (int i = 0; i < 3; ++i) r.real_var[i] = mlmc::Sums::Var(real.f[i], real.f2[i], real.n);
+	r.mc_trials = mc_trials();
+	r.mc_steps = r.mc_trials * (real.fine_steps / real.n);
+	return r;
+}
@@ -4,12 +4,18 @@
 #include <random>
 #include <chrono>
 #include <algorithm>
+#include <functional>
+#include <thread>
+#include "Profiler.h"
+#include "FastMath.h"
 
 struct ExtraBet {
     std::string name;
     float rtp = 0.95f;      // 0..1
     float cost_mult = 0.00f;// extra cost in multiples of base bet
     bool enabled = false;
+    float hit_rate = 0.f;   // chance per spin its feature pays; 0: cost_mult / kFeaturePriceX
+    float volatility = -1.f;// spread of the feature payout 0..1; < 0: the game's
 };
 
 struct Game {
@@ -19,10 +25,26 @@ struct Game {
     float volatility = 0.6f;// 0..1
     float max_win_x = 5000;
     std::vector<ExtraBet> extras;
+    float bonus_rate = 0.f; // free-spin rounds triggered per spin; 0: none
+    float bonus_share = 0.f;// share of the RTP those rounds pay
+    int bonus_spins = 10;   // free spins per round
 };
 
 enum class RiskProfile { Conservative, Balanced, Aggressive };
 
+enum class BetStrategy { Flat, Proportional, Kelly, Ramp, Martingale, Count };
+
+struct StrategyParams {
+    BetStrategy kind = BetStrategy::Flat;
+    float fraction = 0.f;      // proportional: share of the bankroll per spin, 0 = plan bet / start
+    float kelly_scale = 0.5f;  // Kelly: multiple of the growth-optimal stake
+    float ramp_mult = 1.5f;    // ramp: bet multiplier per step
+    int ramp_steps = 3;        // ramp: steps before it stops growing
+    bool ramp_on_win = true;   // ramp: grow after wins, else after losses
+    int max_doublings = 4;     // martingale: doubles this many losses in a row, then resets
+    float min_bet_frac = 0.1f; // bankroll-scaled stakes stay above this share of the plan bet
+};
+
 struct SessionInput {
     float start_bankroll = 100.0f;
     int target_minutes = 0;
@@ -33,6 +55,8 @@ struct SessionInput {
     bool lock_bet_size = false;
     float user_bet_size = 1.0f;
     RiskProfile risk = RiskProfile::Balanced;
+    MathTier payout_math = MathTier::Exact; // kernels for the batched base-game payouts
+    StrategyParams strategy{};              // bet sizing from spin to spin; the plan bet is its base
 };
 
 struct SimResult {
@@ -47,6 +71,10 @@ struct SimResult {
 };
 
 inline std::mt19937& RNG() {
-    static thread_local std::mt19937 rng{ (unsigned)std::chrono::high_resolution_clock::now().time_since_epoch().count() };
+    SP_COUNT(RngCalls, 1);
+    // thread id in the seed: pool workers start within the same clock tick
+    static thread_local std::seed_seq seq{ (unsigned)std::chrono::high_resolution_clock::now().time_since_epoch().count(),
+        (unsigned)std::hash<std::thread::id>{}(std::this_thread::get_id()) };
+    static thread_local std::mt19937 rng{ seq };
     return rng;
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include "Simulator.h"
+#include <climits>
+#include <cmath>
+
+enum class BandEngine { Exact, Strided, Sketch };
+
+inline const char* BandEngineName(BandEngine e) {
+	return e == BandEngine::Exact ? "Exact" : e == BandEngine::Strided ? "Strided" : "Sketch";
+}
+
+struct EngineCost {
+	size_t bytes = 0;
+	double ms = 0.0;
+};
+
+struct BandPlan {
+	BandEngine engine = BandEngine::Strided;
+	BandResolution res{};
+	int spins = 0, trials = 0, points = 0;
+	int sketch_bins = 512;
+	EngineCost exact, strided, sketch; // estimates for every engine
+	EngineCost chosen;
+	bool over_budget = false;          // nothing fit; smallest engine picked anyway
+};
+
+// rough costs measured on a desktop x64 build; upper bounds since most paths stop early
+constexpr double kNsPerSpin = 30.0;
+constexpr double kNsPerSelectElem = 4.5; // FillBandPointSelect, linear in trials
+constexpr int kMinStridedPoints = 32;    // below this a sketch at full resolution reads better
+
+inline EngineCost EstimateSnapshotCost(int points, int spins, int trials) {
+	EngineCost c;
+	c.bytes = size_t(points) * trials * sizeof(float);
+	c.ms = (double(trials) * spins * kNsPerSpin + double(points) * trials * kNsPerSelectElem) * 1e-6;
+	return c;
+}
+
+// largest snapshot count whose points x trials floats fit budget_bytes
+inline int PointsForBudget(size_t budget_bytes, int trials) {
+	return (int)std::min<size_t>(budget_bytes / (size_t(std::max(1, trials)) * sizeof(float)), size_t(INT_MAX));
+}
+
+inline EngineCost EstimateSketchCost(int points, int spins, int trials, int bins) {
+	EngineCost c;
+	c.bytes = size_t(points) * bins * sizeof(uint32_t);
+	c.ms = (double(trials) * spins * kNsPerSpin + double(points) * bins * 5.0) * 1e-6;
+	return c;
+}
+
+// Picks the cheapest engine that keeps the requested resolution inside budget_bytes:
+// exact when every spin is wanted, strided snapshots otherwise. When neither fits, the
+// grid is coarsened to the most points the budget holds, and only when that leaves fewer
+// than kMinStridedPoints does it fall back to a histogram sketch (sketch memory does not
+// grow with trials).
+inline BandPlan PlanBands(const Game& g, const SessionInput& in, const BandResolution& res, size_t budget_bytes) {
+	BandPlan p;
+	BandSetup b = PrepareBands(g, in, res);
+	p.spins = b.spins; p.trials = b.trials; p.points = (int)b.idx.size();
+	p.exact = EstimateSnapshotCost(b.spins + 1, b.spins, b.trials);
+	p.strided = EstimateSnapshotCost(p.points, b.spins, b.trials);
+	p.sketch = EstimateSketchCost(p.points, b.spins, b.trials, p.sketch_bins);
+
+	p.res = res;
+	if (p.points == b.spins + 1 && p.exact.bytes <= budget_bytes) {
+		p.engine = BandEngine::Exact; p.chosen = p.exact;
+	}
+	else if (p.strided.bytes <= budget_bytes) {
+		p.engine = BandEngine::Strided; p.chosen = p.strided;
+	}
+	else if (int fit = PointsForBudget(budget_bytes, b.trials); fit >= kMinStridedPoints) {
+		p.res.points = fit;
+		p.points = (int)BandStepIndices(b.spins, p.res).size();
+		p.strided = EstimateSnapshotCost(p.points, b.spins, b.trials);
+		p.engine = BandEngine::Strided; p.chosen = p.strided;
+	}
+	else {
+		p.engine = BandEngine::Sketch; p.chosen = p.sketch;
+		p.over_budget = p.sketch.bytes > budget_bytes;
+	}
+	return p;
+}
+
+inline PathBands RunBandPlan(const Game& g, const SessionInput& in, const BandPlan& p, PathArena* arena = nullptr) {
+	if (p.engine == BandEngine::Sketch) return SimulatePathBandsSketch(g, in, p.res, p.sketch_bins);
+	return SimulatePathBands(g, in, p.res, arena);
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "BandLod.h"
+#include <imgui.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#ifdef USE_IMPLOT
+#include "implot.h"
+#endif
+
+// Pixel-space triangles for the shaded band and the median line. Built once per
+// data/axis/size change and copied straight into the plot draw list on every other
+// frame, instead of ImPlot re-transforming and re-tessellating identical data.
+struct BandPlotCache {
+	struct Key {
+		uint64_t version = 0; int pixels = 0;
+		ImVec2 pos{}, size{};
+		double x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+		ImU32 fill = 0, line = 0;
+		bool operator==(const Key& o) const {
+			return version == o.version && pixels == o.pixels && pos.x == o.pos.x && pos.y == o.pos.y && size.x == o.size.x && size.y == o.size.y
+				&& x0 == o.x0 && x1 == o.x1 && y0 == o.y0 && y1 == o.y1 && fill == o.fill && line == o.line;
+		}
+	};
+	struct Mesh {
+		std::vector<ImDrawVert> vtx;
+		std::vector<ImDrawIdx> idx;
+		void Clear() { vtx.clear(); idx.clear(); }
+	};
+
+	Key key{};
+	Mesh band, median;
+	bool valid = false;
+
+	// 16-bit indices: stay well inside one draw command per mesh
+	static constexpr size_t kMaxVerts = 60000;
+
+	bool Matches(const Key& k) const { return valid && key == k; }
+
+	void Submit(ImDrawList* dl) const { Submit(dl, band); Submit(dl, median); }
+
+#ifdef USE_IMPLOT
+	static Key MakeKey(const BandLod& lod, ImU32 fill, ImU32 line) {
+		Key k;
+		k.version = lod.version; k.pixels = lod.pixels;
+		k.pos = ImPlot::GetPlotPos(); k.size = ImPlot::GetPlotSize();
+		ImPlotRect r = ImPlot::GetPlotLimits();
+		k.x0 = r.X.Min; k.x1 = r.X.Max; k.y0 = r.Y.Min; k.y1 = r.Y.Max;
+		k.fill = fill; k.line = line;
+		return k;
+	}
+
+	// call between BeginPlot/EndPlot, after setup
+	bool Build(const BandLod& lod, const Key& k, float thickness) {
+		key = k;
+		band.Clear(); median.Clear();
+		const ImVec2 uv = ImGui::GetFontTexUvWhitePixel();
+		auto vert = [&](Mesh& m, ImVec2 p, ImU32 col) { m.vtx.push_back({ p, uv, col }); };
+
+		// band: lo/hi pairs as a strip
+		for (int i = 0; i < lod.Count(); ++i) {
+			vert(band, ImPlot::PlotToPixels(lod.x[i], lod.lo[i]), k.fill);
+			vert(band, ImPlot::PlotToPixels(lod.x[i], lod.hi[i]), k.fill);
+			if (i == 0) continue;
+			ImDrawIdx a = ImDrawIdx(2 * i - 2);
+			ImDrawIdx quad[6] = { a, ImDrawIdx(a + 1), ImDrawIdx(a + 3), a, ImDrawIdx(a + 3), ImDrawIdx(a + 2) };
+			band.idx.insert(band.idx.end(), quad, quad + 6);
+		}
+
+		// median: one quad per segment, offset along the segment normal
+		const float h = thickness * 0.5f;
+		ImVec2 prev = lod.MidCount() ? ImPlot::PlotToPixels(lod.mx[0], lod.mid[0]) : ImVec2{};
+		for (int i = 1; i < lod.MidCount(); ++i) {
+			ImVec2 cur = ImPlot::PlotToPixels(lod.mx[i], lod.mid[i]);
+			float dx = cur.x - prev.x, dy = cur.y - prev.y;
+			float len = std::sqrt(dx * dx + dy * dy);
+			if (len > 0.f) {
+				float nx = -dy / len * h, ny = dx / len * h;
+				ImDrawIdx a = (ImDrawIdx)median.vtx.size();
+				vert(median, { prev.x + nx, prev.y + ny }, k.line);
+				vert(median, { cur.x + nx, cur.y + ny }, k.line);
+				vert(median, { cur.x - nx, cur.y - ny }, k.line);
+				vert(median, { prev.x - nx, prev.y - ny }, k.line);
+				ImDrawIdx quad[6] = { a, ImDrawIdx(a + 1), ImDrawIdx(a + 2), a, ImDrawIdx(a + 2), ImDrawIdx(a + 3) };
+				median.idx.insert(median.idx.end(), quad, quad + 6);
+			}
+			prev = cur;
+		}
+		valid = band.vtx.size() <= kMaxVerts && median.vtx.size() <= kMaxVerts;
+		return valid;
+	}
+#endif
+
+private:
+	static void Submit(ImDrawList* dl, const Mesh& m) {
+		if (m.idx.empty()) return;
+		dl->PrimReserve((int)m.idx.size(), (int)m.vtx.size());
+		const ImDrawIdx base = (ImDrawIdx)dl->_VtxCurrentIdx;
+		std::memcpy(dl->_VtxWritePtr, m.vtx.data(), m.vtx.size() * sizeof(ImDrawVert));
+		for (size_t i = 0; i < m.idx.size(); ++i) dl->_IdxWritePtr[i] = ImDrawIdx(base + m.idx[i]);
+		dl->_VtxWritePtr += m.vtx.size();
+		dl->_IdxWritePtr += m.idx.size();
+		dl->_VtxCurrentIdx += (unsigned)m.vtx.size();
+	}
+};
@@ -0,0 +1,140 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+
+namespace prof {
+
+namespace {
+struct TraceEvent {
+	const char* name;
+	int64_t ts_us, dur_us;
+	uint32_t tid;
+};
+
+constexpr size_t kMaxTraceEvents = size_t(1) << 20;
+
+struct Registry {
+	std::mutex m;
+	std::vector<void*> live;           // LocalCounters of running threads
+	uint64_t retired[CounterCount] = {};
+	std::vector<PhaseStats> phases;
+	std::unordered_map<const char*, size_t> phase_index; // keyed by literal address
+	bool tracing = false;
+	std::vector<TraceEvent> events;
+};
+
+Registry& Reg() { static Registry r; return r; }
+
+int64_t NowUs() {
+	static const auto t0 = std::chrono::steady_clock::now();
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+#ifdef SP_PROFILE
+uint32_t ThreadIndex() {
+	static std::atomic<uint32_t> next{ 1 };
+	static thread_local uint32_t id = next++;
+	return id;
+}
+#endif
+}
+
+#ifdef SP_PROFILE
+LocalCounters::LocalCounters() {
+	Registry& r = Reg();
+	std::lock_guard<std::mutex> lk(r.m);
+	r.live.push_back(this);
+}
+
+LocalCounters::~LocalCounters() {
+	Registry& r = Reg();
+	std::lock_guard<std::mutex> lk(r.m);
+	for (int c = 0; c < CounterCount; ++c) r.retired[c] += v[c].load(std::memory_order_relaxed);
+	r.live.erase(std::remove(r.live.begin(), r.live.end(), (void*)this), r.live.end());
+}
+
+Scope::Scope(const char* name) : name_(name), start_us_(NowUs()) {}
+
+Scope::~Scope() {
+	int64_t end = NowUs();
+	double ms = (end - start_us_) / 1000.0;
+	Registry& r = Reg();
+	std::lock_guard<std::mutex> lk(r.m);
+	auto it = r.phase_index.find(name_);
+	if (it == r.phase_index.end()) {
+		// the same literal can live at different addresses in different translation units
+		size_t i = 0;
+		while (i < r.phases.size() && r.phases[i].name != name_) ++i;
+		if (i == r.phases.size()) r.phases.push_back({ name_ });
+		it = r.phase_index.emplace(name_, i).first;
+	}
+	PhaseStats& p = r.phases[it->second];
+	p.calls++; p.total_ms += ms; p.last_ms = ms; p.max_ms = std::max(p.max_ms, ms);
+	if (r.tracing && r.events.size() < kMaxTraceEvents) r.events.push_back({ name_, start_us_, end - start_us_, ThreadIndex() });
+}
+#endif
+
+void Snapshot(uint64_t out[CounterCount], std::vector<PhaseStats>& phases) {
+	Registry& r = Reg();
+	std::lock_guard<std::mutex> lk(r.m);
+	for (int c = 0; c < CounterCount; ++c) out[c] = r.retired[c];
+#ifdef SP_PROFILE
+	for (void* p : r.live) {
+		auto* lc = static_cast<LocalCounters*>(p);
+		for (int c = 0; c < CounterCount; ++c) out[c] += lc->v[c].load(std::memory_order_relaxed);
+	}
+#endif
+	phases = r.phases;
+}
+
+void Reset() {
+	Registry& r = Reg();
+	std::lock_guard<std::mutex> lk(r.m);
+	for (int c = 0; c < CounterCount; ++c) r.retired[c] = 0;
+#ifdef SP_PROFILE
+	// other threads' slots are rebased by subtracting what they hold now
+	for (void* p : r.live) {
+		auto* lc = static_cast<LocalCounters*>(p);
+		for (int c = 0; c < CounterCount; ++c) r.retired[c] -= lc->v[c].load(std::memory_order_relaxed);
+	}
+#endif
+	r.phases.clear();
+	r.phase_index.clear();
+}
+
+void StartTrace() {
+	Registry& r = Reg();
+	std::lock_guard<std::mutex> lk(r.m);
+	r.tracing = true;
+	r.events.clear();
+	r.events.reserve(4096);
+}
+
+bool WriteTrace(const char* path) {
+	FILE* f = std::fopen(path, "w");
+	if (!f) return false;
+	Registry& r = Reg();
+	std::lock_guard<std::mutex> lk(r.m);
+	std::fprintf(f, "{\"traceEvents\":[\n");
+	bool first = true;
+	for (const TraceEvent& e : r.events) {
+		std::fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%u}", first ? "" : ",\n",
+			e.name, (long long)e.ts_us, (long long)e.dur_us, e.tid);
+		first = false;
+	}
+	// counter totals at the end of the trace
+	uint64_t totals[CounterCount] = {};
+	for (int c = 0; c < CounterCount; ++c) totals[c] = r.retired[c];
+#ifdef SP_PROFILE
+	for (void* p : r.live) for (int c = 0; c < CounterCount; ++c) totals[c] += static_cast<LocalCounters*>(p)->v[c].load(std::memory_order_relaxed);
+#endif
+	std::fprintf(f, "%s{\"name\":\"counters\",\"ph\":\"C\",\"ts\":%lld,\"pid\":1,\"args\":{", first ? "" : ",\n", (long long)NowUs());
+	for (int c = 0; c < CounterCount; ++c) std::fprintf(f, "%s\"%s\":%llu", c ? "," : "", CounterName(c), (unsigned long long)totals[c]);
+	std::fprintf(f, "}}\n],\"displayTimeUnit\":\"ms\"}\n");
+	return std::fclose(f) == 0;
+}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped phase timers and event counters. Without SP_PROFILE every macro below compiles
+// to nothing, so instrumented hot loops cost nothing in stripped builds.
+//
+//   SP_PROFILE_SCOPE("SimulateSession");   // wall time per call, Chrome trace event
+//   SP_COUNT(Spins, n);                    // thread-local add, no atomics in the hot loop
+
+namespace prof {
+
+enum Counter { Spins, Hits, RngCalls, BytesAllocated, CounterCount };
+
+inline const char* CounterName(int c) {
+    static const char* names[] = { "Spins simulated", "Hits drawn", "RNG calls", "Bytes allocated" };
+    return names[c];
+}
+
+struct PhaseStats {
+    std::string name;
+    uint64_t calls = 0;
+    double total_ms = 0.0, last_ms = 0.0, max_ms = 0.0;
+};
+
+#ifdef SP_PROFILE
+constexpr bool kEnabled = true;
+
+// per-thread slots; the owning thread is the only writer, so relaxed load+store is enough
+struct LocalCounters {
+    std::atomic<uint64_t> v[CounterCount] = {};
+    LocalCounters();
+    ~LocalCounters();
+};
+inline LocalCounters& Local() { static thread_local LocalCounters c; return c; }
+inline void Add(Counter c, uint64_t n) {
+    auto& slot = Local().v[c];
+    slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+class Scope {
+public:
+    explicit Scope(const char* name);
+    ~Scope();
+private:
+    const char* name_;
+    int64_t start_us_;
+};
+#else
+constexpr bool kEnabled = false;
+#endif
+
+// aggregated across live and finished threads
+void Snapshot(uint64_t out[CounterCount], std::vector<PhaseStats>& phases);
+void Reset();
+
+// Chrome trace ("chrome://tracing", Perfetto): complete events for every scope
+void StartTrace();
+bool WriteTrace(const char* path);
+
+}
+
+#ifdef SP_PROFILE
+#define SP_PROF_CAT2(a, b) a##b
+#define SP_PROF_CAT(a, b) SP_PROF_CAT2(a, b)
+#define SP_PROFILE_SCOPE(name) prof::Scope SP_PROF_CAT(sp_prof_scope_, __LINE__)(name)
+#define SP_COUNT(counter, n) prof::Add(prof::counter, uint64_t(n))
+#else
+#define SP_PROFILE_SCOPE(name) ((void)0)
+#define SP_COUNT(counter, n) ((void)0)
+#endif
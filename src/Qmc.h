@@ -0,0 +1,184 @@
+#pragma once
+#include "Compare.h"
+#include <cstdint>
+#include <vector>
+
+// Randomized quasi-Monte Carlo: trial i of replicate r is Sobol point i under scrambling
+// r, with spin s reading dimensions 2s (hit) and 2s+1 (payout) through RunCrnTrial. Early
+// spins, which decide most sessions, get the best-distributed dimensions. Independent
+// scramblings give unbiased replicates whose spread is the error estimate.
+//
+// Direction numbers are generated, not tabled: dimension d > 0 uses the d-th primitive
+// polynomial over GF(2) (ordered by degree) with odd initial m_i picked by hash. Owen
+// scrambling makes up for the less tuned initial values. Spins past kMaxDims / 2 fall
+// back to pseudo-random draws.
+class SobolTable {
+public:
+	static constexpr int kMaxDims = 1024;
+	static constexpr int kBits = 32;
+
+	static const SobolTable& Get() { static const SobolTable t(kMaxDims); return t; }
+
+	int Dims() const { return dims_; }
+	// unscrambled coordinate d of point i, as a 32-bit fraction
+	uint32_t Point(uint32_t i, int d) const {
+		const uint32_t* v = &v_[size_t(d) * kBits];
+		uint32_t x = 0, gray = i ^ (i >> 1);
+		for (int k = 0; gray; ++k, gray >>= 1) if (gray & 1) x ^= v[k];
+		return x;
+	}
+
+private:
+	int dims_ = 0;
+	std::vector<uint32_t> v_; // dims x kBits
+
+	explicit SobolTable(int dims) : dims_(dims), v_(size_t(dims) * kBits) {
+		for (int k = 0; k < kBits; ++k) v_[k] = 1u << (31 - k); // dimension 0: van der Corput
+		int d = 1;
+		for (int deg = 1; d < dims; ++deg)
+			for (uint32_t p = (1u << deg) | 1u; p < (2u << deg) && d < dims; p += 2)
+				if (Primitive(p, deg)) Fill(d++, p, deg);
+	}
+
+	static uint32_t MulMod(uint32_t a, uint32_t b, uint32_t p, int deg) {
+		uint32_t r = 0;
+		for (; b; b >>= 1) {
+			if (b & 1) r ^= a;
+			a <<= 1;
+			if (a >> deg & 1) a ^= p;
+		}
+		return r;
+	}
+	static uint32_t PowX(uint64_t e, uint32_t p, int deg) {
+		uint32_t r = 1, base = 2;
+		if (base >> deg & 1) base ^= p;
+		for (; e; e >>= 1) {
+			if (e & 1) r = MulMod(r, base, p, deg);
+			base = MulMod(base, base, p, deg);
+		}
+		return r;
+	}
+	// x has order exactly 2^deg - 1 modulo p
+	static bool Primitive(uint32_t p, int deg) {
+		const uint64_t order = (uint64_t(1) << deg) - 1;
+		if (PowX(order, p, deg) != 1) return false;
+		uint64_t n = order;
+		for (uint64_t q = 2; q * q <= n; ++q) {
+			if (n % q) continue;
+			if (PowX(order / q, p, deg) == 1) return false;
+			while (n % q == 0) n /= q;
+		}
+		return n == 1 || n == order || PowX(order / n, p, deg) != 1;
+	}
+
+	void Fill(int d, uint32_t p, int deg) {
+		uint32_t m[kBits + 1];
+		for (int k = 1; k <= deg && k <= kBits; ++k) {
+			// odd and below 2^k
+			uint32_t h = uint32_t(TrialRng::Mix(uint64_t(d) << 8 | uint64_t(k)));
+			m[k] = ((h % (1u << (k - 1))) << 1) | 1u;
+		}
+		for (int k = deg + 1; k <= kBits; ++k) {
+			uint32_t mk = m[k - deg] ^ (m[k - deg] << deg);
+			for (int j = 1; j < deg; ++j) if (p >> (deg - j) & 1) mk ^= m[k - j] << j;
+			m[k] = mk;
+		}
+		for (int k = 1; k <= kBits; ++k) v_[size_t(d) * kBits + k - 1] = m[k] << (kBits - k);
+	}
+};
+
+inline uint32_t ReverseBits(uint32_t x) {
+	x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+	x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+	x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+	x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+	return (x >> 16) | (x << 16);
+}
+
+// Owen nested uniform scramble as a hash: Laine-Karras permutation on the reversed bits
+// (constants from Burley, "Practical Hash-based Owen Scrambling", 2020). Each bit is
+// flipped depending only on the bits above it.
+inline uint32_t OwenScramble(uint32_t x, uint32_t seed) {
+	x = ReverseBits(x);
+	x += seed;
+	x ^= x * 0x6c50b47cu;
+	x ^= x * 0xb82f1e52u;
+	x ^= x * 0xc7afe638u;
+	x ^= x * 0x8d22f6e6u;
+	return ReverseBits(x);
+}
+
+// uniform stream for one trial: successive dimensions of one scrambled Sobol point
+struct SobolStream {
+	const SobolTable* table;
+	uint32_t index;
+	uint64_t seed;
+	int dim = 0;
+	TrialRng pad; // dimensions past the table
+
+	SobolStream(uint32_t i, uint64_t scramble_seed) : table(&SobolTable::Get()), index(i), seed(scramble_seed), pad(scramble_seed, int(i)) {}
+
+	TrialRng Fork(uint64_t salt) const { return pad.Fork(salt); }
+
+	double Uniform() {
+		if (dim >= table->Dims()) return pad.Uniform();
+		uint32_t dseed = uint32_t(TrialRng::Mix(seed + uint64_t(dim)));
+		uint32_t x = OwenScramble(table->Point(index, dim++), dseed);
+		return (double(x) + 0.5) * (1.0 / 4294967296.0);
+	}
+};
+
+inline uint64_t ReplicateSeed(uint64_t seed, int r) { return TrialRng::Mix(seed ^ (uint64_t(uint32_t(r)) << 32 | 0x9e37u)); }
+
+struct RqmcEstimate {
+	SimResult result;                    // mean over replicates
+	float se_ruin = 0.f, se_hit = 0.f, se_end = 0.f; // standard error across replicates
+	std::vector<SimResult> replicates;
+};
+
+inline RqmcEstimate SummarizeReplicates(const SessionSetup& su, const std::vector<SessionTally>& reps) {
+	RqmcEstimate e;
+	SessionTally all;
+	for (const auto& t : reps) {
+		all.trials += t.trials; all.hit_tp += t.hit_tp; all.ruin += t.ruin; all.end_sum += t.end_sum;
+		if (t.trials > 0) e.replicates.push_back(SessionResult(su, t));
+	}
+	e.result = SessionResult(su, all);
+	const size_t r = e.replicates.size();
+	if (r < 2) return e;
+	auto se = [&](auto field) {
+		double m = 0, ss = 0;
+		for (const auto& x : e.replicates) m += field(x);
+		m /= r;
+		for (const auto& x : e.replicates) ss += (field(x) - m) * (field(x) - m);
+		return float(std::sqrt(ss / (r - 1) / r));
+	};
+	e.se_ruin = se([](const SimResult& x) { return double(x.prob_ruin); });
+	e.se_hit = se([](const SimResult& x) { return double(x.prob_hit_target); });
+	e.se_end = se([](const SimResult& x) { return double(x.expected_end); });
+	return e;
+}
+
+// trial t of an RQMC run: replicates interleave so a partial run covers all of them
+inline TrialOutcome RunRqmcTrial(const Game& g, const SessionInput& in, const SessionSetup& su, uint64_t seed, int reps, int t) {
+	static const std::vector<int> no_snapshots;
+	return RunCrnTrial(g, in, su, SobolStream(uint32_t(t / reps), ReplicateSeed(seed, t % reps)), no_snapshots, [](int, float) {});
+}
+
+// reps scramblings of `points` Sobol points each (powers of two balance best)
+inline RqmcEstimate SimulateSessionRqmc(const Game& g, const SessionInput& in, int points, int reps, uint64_t seed = 0x5107, int threads = 0) {
+	SP_PROFILE_SCOPE("SimulateSessionRqmc");
+	const SessionSetup su = PrepareSession(g, in);
+	const int n = points * reps;
+	std::vector<TrialOutcome> out(n);
+	constexpr int kChunk = 64;
+	TaskPool::ParallelFor((n + kChunk - 1) / kChunk, [&](int c) {
+		for (int t = c * kChunk; t < std::min(n, (c + 1) * kChunk); ++t) out[t] = RunRqmcTrial(g, in, su, seed, reps, t);
+	}, threads);
+	std::vector<SessionTally> tallies(reps);
+	for (int t = 0; t < n; ++t) {
+		SessionTally& ta = tallies[t % reps];
+		ta.trials++; ta.hit_tp += out[t].hit_tp; ta.ruin += out[t].ruin; ta.end_sum += out[t].end;
+	}
+	return SummarizeReplicates(su, tallies);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "Simulator.h"
+#include "TaskPool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct RankRow {
+	int game = 0;
+	std::string name;
+	SimResult r{};
+	float ms = 0.f;
+};
+
+// Same SessionInput against every game. Per-game cost varies by orders of magnitude,
+// so games are handed out by TaskPool's stealing scheduler rather than fixed slices.
+inline void RankGames(const std::vector<Game>& games, const SessionInput& in, std::vector<RankRow>& rows,
+	std::atomic<int>* done = nullptr, const std::atomic<bool>* cancel = nullptr, int threads = 0) {
+	rows.assign(games.size(), RankRow{});
+	TaskPool::ParallelFor((int)games.size(), [&](int i) {
+		if (cancel && *cancel) return;
+		SP_PROFILE_SCOPE("RankGame");
+		auto t0 = std::chrono::steady_clock::now();
+		rows[i].game = i;
+		rows[i].name = games[i].name;
+		rows[i].r = SimulateSession(games[i], in);
+		rows[i].ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+		if (done) ++*done;
+	}, threads);
+}
+
+inline bool WriteRankingCsv(const std::vector<RankRow>& rows, const char* path) {
+	FILE* f = std::fopen(path, "w");
+	if (!f) return false;
+	std::fprintf(f, "game,prob_hit_target,prob_ruin,expected_end\n");
+	for (const auto& row : rows) {
+		std::string name = row.name;
+		for (size_t p = 0; (p = name.find('"', p)) != std::string::npos; p += 2) name.insert(p, 1, '"');
+		std::fprintf(f, "\"%s\",%.4f,%.4f,%.2f\n", name.c_str(), row.r.prob_hit_target, row.r.prob_ruin, row.r.expected_end);
+	}
+	return std::fclose(f) == 0;
+}
+
+// Background ranking for the UI: the worker thread owns rows until Finished().
+class RankingRun {
+public:
+	~RankingRun() { Stop(); }
+
+	void Start(std::vector<Game> games, const SessionInput& in, std::function<void()> on_done = {}) {
+		Stop();
+		games_ = std::move(games);
+		total_ = (int)games_.size();
+		done_ = 0; cancel_ = false; finished_ = false;
+		worker_ = std::thread([this, in, on_done] {
+			RankGames(games_, in, rows_, &done_, &cancel_);
+			finished_ = true;
+			if (on_done) on_done();
+		});
+	}
+	void Stop() {
+		cancel_ = true;
+		if (worker_.joinable()) worker_.join();
+	}
+	bool Running() const { return worker_.joinable() && !finished_; }
+	bool Finished() const { return finished_; }
+	int Done() const { return done_; }
+	int Total() const { return total_; }
+	std::vector<RankRow>& Rows() { return rows_; }
+
+private:
+	std::vector<Game> games_;
+	std::vector<RankRow> rows_;
+	std::thread worker_;
+	std::atomic<int> done_{ 0 };
+	std::atomic<bool> cancel_{ false }, finished_{ false };
+	int total_ = 0;
+};
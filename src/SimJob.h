@@ -0,0 +1,198 @@
+#pragma once
+#include "Planner.h"
+#include "Qmc.h"
+#include "Fixed.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Resumable SimulateSession / RunBandPlan for the UI thread. Step() runs whole chunks of
+// trials until its deadline passes and returns, so a build without worker threads can
+// interleave simulation with drawing. Game and input are copied at Start(), later edits
+// don't touch a run in flight.
+namespace simjob {
+using Clock = std::chrono::steady_clock;
+
+// ~20k spins between clock checks, well under a millisecond
+inline int ChunkTrials(int spins) { return std::max(1, 20000 / std::max(1, spins)); }
+inline int ChunkPoints(int trials) { return std::max(1, 200000 / std::max(1, trials)); }
+}
+
+// Random: the pseudo-random trial loop. Qmc: scrambled Sobol replicates. Fixed: seeded
+// per-trial streams with integer cent accounting.
+enum class SessionEngine { Random, Qmc, Fixed };
+
+class SessionJob {
+public:
+	static constexpr int kQmcReplicates = 8;
+
+	void Start(const Game& g, const SessionInput& in, SessionEngine engine = SessionEngine::Random) {
+		g_ = g; in_ = in; engine_ = engine;
+		setup_ = PrepareSession(g_, in_);
+		tally_ = {};
+		reps_.assign(Qmc() ? kQmcReplicates : 0, SessionTally{});
+		running_ = true;
+	}
+	void Cancel() { running_ = false; }
+	bool Running() const { return running_; }
+
+	// true once every trial has run
+	bool Step(simjob::Clock::time_point deadline) {
+		if (!running_) return true;
+		SP_PROFILE_SCOPE("SessionJob");
+		const int chunk = simjob::ChunkTrials(setup_.plan.planned_spins);
+		do {
+			int t1 = std::min(setup_.trials, tally_.trials + chunk);
+			if (engine_ == SessionEngine::Qmc) RunQmc(tally_.trials, t1);
+			else if (engine_ == SessionEngine::Fixed) SimulateSessionTrialsFixed(g_, in_, setup_, tally_.trials, t1, tally_);
+			else SimulateSessionTrials(g_, in_, setup_, tally_.trials, t1, tally_);
+		} while (tally_.trials < setup_.trials && simjob::Clock::now() < deadline);
+		running_ = tally_.trials < setup_.trials;
+		return !running_;
+	}
+
+	SimResult Result() const { return SessionResult(setup_, tally_); } // partial while running
+	int Done() const { return tally_.trials; }
+	int Total() const { return setup_.trials; }
+	bool Qmc() const { return engine_ == SessionEngine::Qmc; }
+	RqmcEstimate QmcEstimate() const { return SummarizeReplicates(setup_, reps_); } // error bars in QMC mode
+
+private:
+	Game g_;
+	SessionInput in_{};
+	SessionSetup setup_{};
+	SessionTally tally_{};
+	std::vector<SessionTally> reps_; // per scrambling
+	SessionEngine engine_ = SessionEngine::Random;
+	bool running_ = false;
+
+	void RunQmc(int t0, int t1) {
+		for (int t = t0; t < t1; ++t) {
+			TrialOutcome o = RunRqmcTrial(g_, in_, setup_, 0x5107, kQmcReplicates, t);
+			for (SessionTally* ta : { &tally_, &reps_[t % kQmcReplicates] }) {
+				ta->trials++; ta->hit_tp += o.hit_tp; ta->ruin += o.ruin; ta->end_sum += o.end;
+			}
+		}
+	}
+};
+
+// Bands are refined progressively: the first refresh runs after kFirstBatch trials and
+// every later one after the trial count doubles. The snapshot engine re-selects each
+// step's percentiles from every trial so far (SelectPercentiles is linear, so the doubling
+// schedule costs about two passes over the final snapshot) with points spread over the
+// TaskPool; the sketch just keeps counting.
+class BandJob {
+public:
+	static constexpr int kFirstBatch = 128;
+
+	void Start(const Game& g, const SessionInput& in, const BandPlan& plan, PathArena* arena) {
+		g_ = g; in_ = in; plan_ = plan;
+		b_ = PrepareBands(g_, in_, plan_.res);
+		bands_ = AllocBands(b_);
+		next_trial_ = next_point_ = shown_ = refreshes_ = 0;
+		next_refresh_ = std::min(b_.trials, kFirstBatch);
+		median_err_ = 0.f;
+		err_.assign(bands_.steps, 0.f);
+		snap_ = nullptr;
+		if (plan_.engine == BandEngine::Sketch) sk_.Reset((int)b_.idx.size(), plan_.sketch_bins, 0.f, b_.tp);
+		else {
+			// step-major like SimulatePathBands
+			const size_t count = b_.idx.size() * size_t(b_.trials);
+			snap_ = arena ? arena->Acquire(count) : nullptr;
+			if (!snap_) { local_.resize(count); snap_ = local_.data(); }
+		}
+		phase_ = Phase::Simulate;
+	}
+	void Cancel() { phase_ = Phase::Idle; }
+	bool Running() const { return phase_ == Phase::Simulate || phase_ == Phase::Refresh; }
+	bool Finished() const { return phase_ == Phase::Done; }
+
+	// true once the bands cover every trial
+	bool Step(simjob::Clock::time_point deadline) {
+		if (!Running()) return Finished();
+		SP_PROFILE_SCOPE("BandJob");
+		const int points = bands_.steps, trials = b_.trials;
+		do {
+			if (phase_ == Phase::Simulate) {
+				const int chunk = simjob::ChunkTrials(b_.spins);
+				do {
+					int t1 = std::min(next_refresh_, next_trial_ + chunk);
+					if (snap_) SimulateBandTrials(g_, in_, b_, next_trial_, t1, [&](int k, int t, float v) { snap_[size_t(k) * trials + t] = v; });
+					else SimulateBandTrials(g_, in_, b_, next_trial_, t1, [&](int k, int, float v) { sk_.Add(k, v); });
+					next_trial_ = t1;
+				} while (next_trial_ < next_refresh_ && simjob::Clock::now() < deadline);
+				if (next_trial_ < next_refresh_) return false;
+				phase_ = Phase::Refresh;
+				next_point_ = 0;
+			}
+
+			const int n = next_trial_;
+			const int chunk = snap_ ? simjob::ChunkPoints(n) * TaskPool::DefaultThreads() : simjob::ChunkPoints(plan_.sketch_bins);
+			do {
+				int k1 = std::min(points, next_point_ + chunk);
+				RefreshPoints(next_point_, k1, n);
+				next_point_ = k1;
+			} while (next_point_ < points && simjob::Clock::now() < deadline);
+			if (next_point_ < points) return false;
+
+			shown_ = n;
+			median_err_ = *std::max_element(err_.begin(), err_.end());
+			++refreshes_;
+			if (n == trials) { phase_ = Phase::Done; return true; }
+			next_refresh_ = std::min(trials, 2 * n);
+			phase_ = Phase::Simulate;
+		} while (simjob::Clock::now() < deadline);
+		return false;
+	}
+
+	float Progress() const { return phase_ == Phase::Done ? 1.f : float(next_trial_) / std::max(1, b_.trials); }
+	const BandPlan& Plan() const { return plan_; }
+	const PathBands& Bands() const { return bands_; } // consistent whenever Refreshes() bumps
+	int Refreshes() const { return refreshes_; }       // bumps whenever Bands() changes
+	int Trials() const { return shown_; }              // trials behind Bands()
+	float MedianError() const { return median_err_; }  // widest 95% half-width of p50 over all steps
+
+private:
+	enum class Phase { Idle, Simulate, Refresh, Done };
+
+	// updates points [i0, i1) from the first n trials, their p50 95% half-widths into err_
+	void RefreshPoints(int i0, int i1, int n) {
+		// order statistics bracketing the median: rank error 1.96 * sqrt(p (1 - p) / n)
+		const float dp = 100.f * 1.96f * 0.5f / std::sqrt(float(n));
+		const float plo = std::max(0.f, 50.f - dp), phi = std::min(100.f, 50.f + dp);
+		if (!snap_) {
+			for (int i = i0; i < i1; ++i) {
+				FillBandPoint(bands_, i, sk_);
+				err_[i] = 0.5f * (sk_.Quantile(i, phi) - sk_.Quantile(i, plo));
+			}
+			return;
+		}
+		constexpr int kChunk = 16;
+		const float pct[7] = { 10, 25, 50, 75, 90, plo, phi };
+		const int threads = size_t(i1 - i0) * n < (size_t(1) << 16) ? 1 : 0; // as FillBands
+		TaskPool::ParallelFor((i1 - i0 + kChunk - 1) / kChunk, [&](int c) {
+			SelectScratch s;
+			float q[7];
+			for (int i = i0 + c * kChunk; i < std::min(i1, i0 + (c + 1) * kChunk); ++i) {
+				SelectPercentiles(snap_ + size_t(i) * b_.trials, n, pct, q, 7, s);
+				bands_.p10[i] = q[0]; bands_.p25[i] = q[1]; bands_.p50[i] = q[2]; bands_.p75[i] = q[3]; bands_.p90[i] = q[4];
+				err_[i] = 0.5f * (q[6] - q[5]);
+			}
+		}, threads);
+	}
+
+	Phase phase_ = Phase::Idle;
+	Game g_;
+	SessionInput in_{};
+	BandPlan plan_{};
+	BandSetup b_{};
+	PathBands bands_{};
+	BandSketch sk_;
+	float* snap_ = nullptr;
+	std::vector<float> local_;
+	int next_trial_ = 0, next_point_ = 0;
+	int next_refresh_ = 0; // trial count of the next refresh
+	int shown_ = 0, refreshes_ = 0;
+	float median_err_ = 0.f;
+	std::vector<float> err_; // p50 half-width per point, last refresh
+};
@@ -1,27 +1,53 @@
 #pragma once
 #include "Models.h"
+#include "Arena.h"
+#include "Extras.h"
+#include "Strategy.h"
+#include "TaskPool.h"
 #include <cmath>
 #include <random>
 #include <numeric>
+#include <cstdint>
+#include <bit>
+#include <cstring>
 
-inline void ComputeEffectiveGame(const Game& g, float& rtp_eff, float& cost_mult_eff) {
-	rtp_eff = g.rtp;
-	cost_mult_eff = 1.0f;
-	for (const auto& e : g.extras) if (e.enabled) {
-		float extra_cost = e.cost_mult;
-		float old_cost = cost_mult_eff;
-		cost_mult_eff += extra_cost;
-		rtp_eff = (rtp_eff * old_cost + extra_cost * e.rtp) / cost_mult_eff;
+// A base-game hit pays a lognormal multiple of the bet, mean mean_on_hit, sigma rising
+// with volatility, capped at max_x. PayoutBatch draws a whole batch of hits at once: kSize
+// uniforms from src, then one pass of the tier's kernels over the array. Every tier goes
+// through here, in the session and band loops alike; even Exact's std:: calls beat one
+// std::lognormal_distribution per hit by about 2x. Exact draws by inverse CDF, so a seeded
+// run's payouts differ from the per-hit std::lognormal_distribution of older builds though
+// the distribution is the same. Hits a trial doesn't reach are dropped, they're
+// independent of what came before.
+class PayoutBatch {
+public:
+	static constexpr int kSize = 64;
+	static_assert(kSize % fastmath::kBlock == 0);
+
+	PayoutBatch(float mean_on_hit, float volatility, float max_x, MathTier tier) : max_x_(max_x), tier_(tier) {
+		sigma_ = 0.5f + 1.5f * std::clamp(volatility, 0.0f, 1.0f);
+		mu_ = std::log(std::max(1e-4f, mean_on_hit)) - 0.5f * sigma_ * sigma_;
+	}
+	template<class Src>
+	float Next(Src& src) {
+		if (pos_ == kSize) {
+			for (int i = 0; i < kSize; ++i) {
+				const double u = src.Uniform();
+				q_[i] = float(std::min(u, 1.0 - u));
+				sign_[i] = u > 0.5 ? 1.f : -1.f;
+			}
+			fastmath::LognormalFromUniform(tier_, q_, sign_, x_, kSize, mu_, sigma_, max_x_);
+			pos_ = 0;
+		}
+		return x_[pos_++];
 	}
-}
 
-inline float DrawPayoutMult(float mean_on_hit, float volatility, float max_x) {
-	float sigma = 0.5f + 1.5f * std::clamp(volatility, 0.0f, 1.0f);
-	float mu = std::log(std::max(1e-4f, mean_on_hit)) - 0.5f * sigma * sigma;
-	std::lognormal_distribution<float> dist(mu, sigma);
-	float x = dist(RNG());
-	return x > max_x ? max_x : x;
-}
+private:
+	float mu_, sigma_, max_x_;
+	MathTier tier_;
+	float q_[kSize], sign_[kSize], x_[kSize];
+	int pos_ = kSize;
+};
 
 inline float SuggestTakeProfit(float start, RiskProfile risk) {
 	float m;
@@ -46,153 +72,449 @@ inline float SuggestBetSize(float bankroll, float rtp_eff, float /*hit_rate*/, R
 	return std::clamp(bet, 0.01f, bankroll * 0.10f);
 }
 
-inline SimResult SimulateSession(const Game& g, const SessionInput& in) {
-	SimResult out{};
-	float rtp_eff, cost_mult; ComputeEffectiveGame(g, rtp_eff, cost_mult);
+struct SessionSetup {
+	float rtp_eff = 1.f, cost_mult = 1.f; // blended over the extras, for sizing
+	ExtraProcess extras;                  // what the extras actually pay
+	StrategySetup strategy;               // in.strategy against the plan bet
+	int trials = 0;
+	SimResult plan{}; // bet, targets and horizon; probabilities left empty
+};
+
+struct SessionTally {
+	int trials = 0, hit_tp = 0, ruin = 0;
+	double end_sum = 0.0;
+};
+
+// bet, targets and horizon only; extras left empty, so no feature tables get built
+inline SessionSetup PlanSession(const Game& g, const SessionInput& in) {
+	SessionSetup s;
+	ComputeEffectiveGame(g, s.rtp_eff, s.cost_mult);
+	SimResult& out = s.plan;
 	int spins = in.include_time && in.target_minutes > 0 ? in.target_minutes * std::max(1, in.spins_per_min) : in.max_spins_cap;
 	out.planned_spins = spins;
-	out.expected_loss_per_spin = cost_mult * (1.0f - rtp_eff);
-	out.recommended_bet = in.lock_bet_size ? in.user_bet_size : SuggestBetSize(in.start_bankroll, rtp_eff, g.hit_rate, in.risk, spins);
+	out.expected_loss_per_spin = s.cost_mult * (1.0f - s.rtp_eff);
+	out.recommended_bet = in.lock_bet_size ? in.user_bet_size : SuggestBetSize(in.start_bankroll, s.rtp_eff, g.hit_rate, in.risk, spins);
 	out.stop_loss = SuggestStopLoss(in.start_bankroll, in.risk);
 	out.take_profit = SuggestTakeProfit(in.start_bankroll, in.risk);
+	s.trials = std::max(100, in.trials);
+	return s;
+}
+
+inline SessionSetup PrepareSession(const Game& g, const SessionInput& in) {
+	SessionSetup s = PlanSession(g, in);
+	s.extras = PrepareExtras(g);
+	s.strategy = PrepareStrategy(in.strategy, g, in, s.plan.recommended_bet, s.cost_mult, s.extras);
+	return s;
+}
 
-	int trials = std::max(100, in.trials);
+// Runs trials [t0, t1) and adds their outcomes to tally, staking what strat asks each
+// spin. Real is the type the bankroll, stake and thresholds are carried in: double for
+// reference runs, float for half the state per trial (--bench-precision reports the
+// drift). Tallies are double either way.
+template<class Real, class Strategy>
+inline void SimulateSessionTrialsWith(const Game& g, const SessionInput& in, const SessionSetup& su, const Strategy& strat, int t0, int t1, SessionTally& tally) {
+	const SimResult& out = su.plan;
+	const Real tp = out.take_profit, sl = out.stop_loss;
+	const int spins = out.planned_spins;
+	const bool extras = su.extras.Count() > 0;
 	std::bernoulli_distribution hit(g.hit_rate);
+	ExtraBatch batch;
+	StdExtraSource src;
+	PayoutBatch pay(BaseMeanOnHit(g), g.volatility, g.max_win_x, in.payout_math);
 
 	int hit_tp = 0, ruin = 0; double end_sum = 0.0;
-	for (int t = 0; t < trials; ++t) {
-		double bank = in.start_bankroll;
+	uint64_t n_spins = 0, n_hits = 0;
+	for (int t = t0; t < t1; ++t) {
+		Strategy policy = strat; // fresh state per trial
+		Real bank = in.start_bankroll;
+		if (extras) batch.Reset(su.extras, src);
 		for (int s = 0; s < spins; ++s) {
-			double bet_total = out.recommended_bet * cost_mult;
-			if (bank < bet_total) break;
+			const Real bet = policy.Bet(double(bank), su.cost_mult);
+			if (bet <= Real(0)) break;
+			const Real bet_total = bet * Real(su.cost_mult);
 			bank -= bet_total;
+			++n_spins;
+			Real won = 0;
 			if (hit(RNG())) {
-				float mean_on_hit = (rtp_eff * cost_mult) / std::max(0.001f, g.hit_rate);
-				float mult = DrawPayoutMult(mean_on_hit, g.volatility, g.max_win_x);
-				bank += out.recommended_bet * mult; // payout on base bet
+				++n_hits;
+				won = bet * Real(pay.Next(src)); // payout on base bet
 			}
-			if (bank >= out.take_profit) { ++hit_tp; break; }
-			if (bank <= out.stop_loss) { ++ruin; break; }
+			if (extras) won += bet * Real(batch.Next(su.extras, src));
+			bank += won;
+			policy.Settle(won > bet_total);
+			if (bank >= tp) { ++hit_tp; break; }
+			if (bank <= sl) { ++ruin; break; }
 		}
-		end_sum += bank;
+		end_sum += double(bank);
 	}
-	out.prob_hit_target = float(hit_tp) / trials;
-	out.prob_ruin = float(ruin) / trials;
-	out.expected_end = float(end_sum / trials);
+	SP_COUNT(Spins, n_spins);
+	SP_COUNT(Hits, n_hits);
+	tally.trials += t1 - t0;
+	tally.hit_tp += hit_tp; tally.ruin += ruin; tally.end_sum += end_sum;
+}
+
+template<class Real = double>
+inline void SimulateSessionTrials(const Game& g, const SessionInput& in, const SessionSetup& su, int t0, int t1, SessionTally& tally) {
+	VisitStrategy(su.strategy, [&](const auto& strat) { SimulateSessionTrialsWith<Real>(g, in, su, strat, t0, t1, tally); });
+}
+
+// estimates over the trials run so far
+inline SimResult SessionResult(const SessionSetup& su, const SessionTally& tally) {
+	SimResult out = su.plan;
+	if (tally.trials <= 0) return out;
+	out.prob_hit_target = float(tally.hit_tp) / tally.trials;
+	out.prob_ruin = float(tally.ruin) / tally.trials;
+	out.expected_end = float(tally.end_sum / tally.trials);
 	return out;
 }
 
+template<class Real = double>
+inline SimResult SimulateSession(const Game& g, const SessionInput& in) {
+	SP_PROFILE_SCOPE("SimulateSession");
+	SessionSetup su = PrepareSession(g, in);
+	SessionTally tally;
+	SimulateSessionTrials<Real>(g, in, su, 0, su.trials, tally);
+	return SessionResult(su, tally);
+}
+
+struct BandResolution {
+	int points = 400;        // max snapshots per path (<= 0: every spin)
+	bool log_spaced = false; // denser near the start of the session
+};
+
 struct PathBands {
-	int steps = 0;
+	int steps = 0;           // recorded points
+	int spins = 0;           // simulated horizon
+	std::vector<float> x;    // spin index of each point
 	std::vector<float> p10, p25, p50, p75, p90;
 };
 
+// spins to snapshot: always 0 and the final spin, strided or log-spaced in between
+inline std::vector<int> BandStepIndices(int spins, const BandResolution& res) {
+	if (spins < 1) return { 0 };
+	std::vector<int> idx;
+	int n = res.points <= 0 ? spins + 1 : std::clamp(res.points, 2, spins + 1);
+	idx.reserve(n);
+	if (n == spins + 1) {
+		for (int i = 0; i <= spins; ++i) idx.push_back(i);
+		return idx;
+	}
+	for (int k = 0; k < n; ++k) {
+		double f = double(k) / (n - 1);
+		int s = res.log_spaced ? int(std::lround(std::pow(double(spins + 1), f))) - 1 : int(std::lround(f * spins));
+		if (idx.empty() || s > idx.back()) idx.push_back(s);
+	}
+	idx.back() = spins;
+	return idx;
+}
+
 
 // helper
-inline float Percentile(std::vector<float>& v, float p) {
-	if (v.empty()) return 0.f;
-	std::sort(v.begin(), v.end());
-	float idx = (p / 100.f) * (v.size() - 1);
+inline float PercentileSorted(const float* v, size_t n, float p) {
+	if (!n) return 0.f;
+	float idx = (p / 100.f) * (n - 1);
 	size_t i = (size_t)idx;
 	float frac = idx - i;
-	if (i + 1 < v.size()) return v[i] * (1.f - frac) + v[i + 1] * frac;
-	return v.back();
+	if (i + 1 < n) return v[i] * (1.f - frac) + v[i + 1] * frac;
+	return v[n - 1];
 }
 
-inline float DrawPayoutMultMixture(float mean_on_hit, float volatility, float max_x) {
-	float v = std::clamp(volatility, 0.f, 1.f);
-	float w_big = 0.05f + 0.15f * v;         // 5% .. 20% big-hit chance
-	float r = 6.0f + 24.0f * v;         // big 6x..30x the small mean
-
-	float denom = (1.0f - w_big) + w_big * r;
-	float m_small = mean_on_hit / std::max(denom, 1e-6f);
-	float m_big = r * m_small;
-
-	auto draw = [&](float mean) {
-		float sigma = 0.45f + 1.7f * v;
-		float mu = std::log(std::max(1e-4f, mean)) - 0.5f * sigma * sigma;
-		std::lognormal_distribution<float> dist(mu, sigma);
-		float x = dist(RNG());
-		return std::min(x, max_x);
-		};
-
-	std::bernoulli_distribution big(w_big);
-	return draw(big(RNG()) ? m_big : m_small);
+inline float Percentile(std::vector<float>& v, float p) {
+	std::sort(v.begin(), v.end());
+	return PercentileSorted(v.data(), v.size(), p);
 }
 
-inline PathBands SimulatePathBands(const Game& g, const SessionInput& in) {
-	float rtp_eff, cost_mult; ComputeEffectiveGame(g, rtp_eff, cost_mult);
-	int spins = in.include_time && in.target_minutes > 0 ? in.target_minutes * std::max(1, in.spins_per_min) : in.max_spins_cap;
+struct BandSetup {
+	float rtp_eff = 1.f, cost_mult = 1.f;
+	float bet = 0.f, tp = 0.f, sl = 0.f;
+	int spins = 0, trials = 0;
+	std::vector<int> idx; // snapshot spins
+	ExtraProcess extras;
+	StrategySetup strategy;
+};
 
+inline int BandSpins(const SessionInput& in, float rtp_eff, float cost_mult) {
+	int spins = in.include_time && in.target_minutes > 0 ? in.target_minutes * std::max(1, in.spins_per_min) : in.max_spins_cap;
 	if (!in.include_time)
 		spins = std::min(spins, std::max(50, int((in.start_bankroll / std::max(0.001f, cost_mult * (1.f - rtp_eff))) * 1.2f)));
+	return spins;
+}
 
-	float bet = in.lock_bet_size ? in.user_bet_size : SuggestBetSize(in.start_bankroll, rtp_eff, g.hit_rate, in.risk, spins);
-	float tp = SuggestTakeProfit(in.start_bankroll, in.risk);
-	float sl = SuggestStopLoss(in.start_bankroll, in.risk);
+inline BandSetup PrepareBands(const Game& g, const SessionInput& in, const BandResolution& res) {
+	BandSetup b;
+	ComputeEffectiveGame(g, b.rtp_eff, b.cost_mult);
+	b.extras = PrepareExtras(g);
+	b.spins = BandSpins(in, b.rtp_eff, b.cost_mult);
+	b.bet = in.lock_bet_size ? in.user_bet_size : SuggestBetSize(in.start_bankroll, b.rtp_eff, g.hit_rate, in.risk, b.spins);
+	b.tp = SuggestTakeProfit(in.start_bankroll, in.risk);
+	b.sl = SuggestStopLoss(in.start_bankroll, in.risk);
+	b.trials = std::max(200, in.trials);
+	b.idx = BandStepIndices(b.spins, res);
+	b.strategy = PrepareStrategy(in.strategy, g, in, b.bet, b.cost_mult, b.extras);
+	return b;
+}
 
-	int trials = std::max(200, in.trials);
+// Runs trials [t0, t1) and calls record(point, trial, bankroll) for every snapshot point.
+// Real and strat as in SimulateSessionTrialsWith; snapshots are float regardless.
+template<class Real, class Strategy, class Record>
+inline void SimulateBandTrialsWith(const Game& g, const SessionInput& in, const BandSetup& b, const Strategy& strat, int t0, int t1, Record&& record) {
 	std::bernoulli_distribution hit(g.hit_rate);
+	const int points = (int)b.idx.size();
+	auto record_rest = [&](int from, int t, float v) { for (int k = from; k < points; ++k) record(k, t, v); };
+	uint64_t n_spins = 0, n_hits = 0;
+	const bool extras = b.extras.Count() > 0;
+	ExtraBatch batch;
+	StdExtraSource src;
+	PayoutBatch pay(BaseMeanOnHit(g), g.volatility, g.max_win_x, in.payout_math);
 
-	std::vector<std::vector<float>> snapshots(spins + 1);
-	for (auto& s : snapshots) s.reserve(trials);
+	for (int t = t0; t < t1; ++t) {
+		Strategy policy = strat;
+		Real bank = in.start_bankroll;
+		int next = 1; // next snapshot to record
+		if (extras) batch.Reset(b.extras, src);
 
-	for (int t = 0; t < trials; ++t) {
-		double bank = in.start_bankroll;
-		double peak = bank;
-		// ratcheting SL: track 25% of gains
-		auto soft_stop = [&](double b) {
-			double gain = std::max(0.0, b - in.start_bankroll);
-			return std::max<double>(sl, in.start_bankroll + gain * 0.25);
-			};
-
-		snapshots[0].push_back(float(bank));
-		for (int s = 0; s < spins; ++s) {
-			double spin_cost = bet * cost_mult;
-			if (bank < spin_cost) { // record flat until end
-				for (int k = s + 1; k <= spins; ++k) snapshots[k].push_back(float(bank));
+		record(0, t, float(bank));
+		for (int s = 0; s < b.spins; ++s) {
+			const Real bet = policy.Bet(double(bank), b.cost_mult);
+			if (bet <= Real(0)) { // record flat until end
+				record_rest(next, t, float(bank));
 				break;
 			}
+			const Real spin_cost = bet * Real(b.cost_mult);
 			bank -= spin_cost;
+			++n_spins;
 
+			Real won = 0;
 			if (hit(RNG())) {
-				float mean_on_hit = g.rtp / std::max(0.001f, g.hit_rate);
-				float mult = DrawPayoutMultMixture(mean_on_hit, g.volatility, g.max_win_x);
-				bank += bet * mult; // payout on base bet only
+				++n_hits;
+				won = bet * Real(pay.Next(src)); // payout on base bet only
 			}
+			if (extras) won += bet * Real(batch.Next(b.extras, src));
+			bank += won;
+			policy.Settle(won > spin_cost);
 
-			double peak = bank;
-			const double trail_pct = 0.25;      // 25% of gains
+			Real peak = bank;
+			const Real trail_pct = Real(0.25);      // 25% of gains
 
 			peak = std::max(peak, bank);
-			double ts = sl + (peak - in.start_bankroll) * trail_pct;
+			Real ts = Real(b.sl) + (peak - Real(in.start_bankroll)) * trail_pct;
 
-			if (bank >= tp) {
-				for (int k = s + 1; k <= spins; ++k) snapshots[k].push_back(float(tp));
+			if (bank >= Real(b.tp)) {
+				record_rest(next, t, b.tp);
 				break;
 			}
 			if (bank <= ts) {
-				for (int k = s + 1; k <= spins; ++k) snapshots[k].push_back(std::max((float)bank, sl));
+				record_rest(next, t, std::max((float)bank, b.sl));
 				break;
 			}
-			snapshots[s + 1].push_back(float(bank));
+			if (b.idx[next] == s + 1) record(next++, t, float(bank));
 		}
 	}
+	SP_COUNT(Spins, n_spins);
+	SP_COUNT(Hits, n_hits);
+}
+
+template<class Real = double, class Record>
+inline void SimulateBandTrials(const Game& g, const SessionInput& in, const BandSetup& b, int t0, int t1, Record&& record) {
+	VisitStrategy(b.strategy, [&](const auto& strat) { SimulateBandTrialsWith<Real>(g, in, b, strat, t0, t1, record); });
+}
 
-	PathBands bands; bands.steps = spins + 1;
+inline PathBands AllocBands(const BandSetup& b) {
+	PathBands bands; bands.steps = (int)b.idx.size(); bands.spins = b.spins;
+	bands.x.resize(bands.steps);
 	bands.p10.resize(bands.steps);
 	bands.p25.resize(bands.steps);
 	bands.p50.resize(bands.steps);
 	bands.p75.resize(bands.steps);
 	bands.p90.resize(bands.steps);
+	for (int i = 0; i < bands.steps; ++i) bands.x[i] = (float)b.idx[i];
+	return bands;
+}
+
+inline void FillBandPointSorted(PathBands& bands, int i, const float* v, int n) {
+	bands.p10[i] = PercentileSorted(v, n, 10);
+	bands.p25[i] = PercentileSorted(v, n, 25);
+	bands.p50[i] = PercentileSorted(v, n, 50);
+	bands.p75[i] = PercentileSorted(v, n, 75);
+	bands.p90[i] = PercentileSorted(v, n, 90);
+}
+
+// sorts one step's bankrolls in place
+inline void FillBandPoint(PathBands& bands, int i, float* v, int n) {
+	std::sort(v, v + n);
+	FillBandPointSorted(bands, i, v, n);
+}
+
+// Monotone bit-cast: unsigned order of the keys is the float order (no NaNs).
+inline uint32_t FloatKey(float f) {
+	uint32_t u; std::memcpy(&u, &f, sizeof(u));
+	return (u & 0x80000000u) ? ~u : u | 0x80000000u;
+}
+inline float KeyFloat(uint32_t k) {
+	uint32_t u = (k & 0x80000000u) ? k & 0x7fffffffu : ~k;
+	float f; std::memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+struct SelectScratch {
+	std::vector<uint32_t> hist, cand;
+	std::vector<uint8_t> slot;
+};
+
+// Percentiles pct[0..np) of v[0..n) as PercentileSorted would give them, without sorting;
+// v is left untouched, pct in any order, np <= kMaxSelect. One sweep finds the key range,
+// a second histograms the top kBits of (key - min) to find the bucket of each rank, a
+// third gathers only those buckets, which are then selected in place. Linear on average.
+constexpr int kMaxSelect = 8;
+inline void SelectPercentiles(const float* v, int n, const float* pct, float* out, int np, SelectScratch& s) {
+	constexpr int kBits = 11;
+	if (n <= 0) { std::fill(out, out + np, 0.f); return; }
+
+	uint32_t kmin = ~0u, kmax = 0;
+	for (int t = 0; t < n; ++t) { uint32_t k = FloatKey(v[t]); kmin = std::min(kmin, k); kmax = std::max(kmax, k); }
+	if (kmin == kmax) { std::fill(out, out + np, v[0]); return; }
+
+	const uint32_t range = kmax - kmin;
+	const int shift = std::max(0, int(std::bit_width(range)) - kBits);
+	const int nb = int(range >> shift) + 1;
+	s.hist.assign(nb, 0u);
+	for (int t = 0; t < n; ++t) s.hist[(FloatKey(v[t]) - kmin) >> shift]++;
+
+	// ranks as PercentileSorted computes them, lo and lo + 1 of each percentile, ascending
+	struct Want { size_t rank; int q; };
+	Want want[2 * kMaxSelect]; float frac[kMaxSelect]; int nr = 0;
+	for (int q = 0; q < np; ++q) {
+		float idx = (pct[q] / 100.f) * (n - 1);
+		size_t r = (size_t)idx;
+		frac[q] = idx - r;
+		want[nr++] = { r, 2 * q };
+		want[nr++] = { std::min(r + 1, size_t(n) - 1), 2 * q + 1 };
+	}
+	std::sort(want, want + nr, [](const Want& x, const Want& y) { return x.rank < y.rank; });
+
+	// bucket of each rank; buckets that hold ranks get a slot in cand
+	int bucket[2 * kMaxSelect], slots = 0;
+	uint32_t slot_begin[2 * kMaxSelect + 1], cum_at[2 * kMaxSelect];
+	s.slot.assign(nb, 0);
+	uint32_t cum = 0, total = 0;
+	for (int r = 0, b = 0; r < nr; ++r) {
+		while (cum + s.hist[b] <= want[r].rank) cum += s.hist[b++];
+		bucket[r] = b; cum_at[r] = cum;
+		if (!s.slot[b]) { s.slot[b] = uint8_t(++slots); slot_begin[slots - 1] = total; total += s.hist[b]; }
+	}
+	slot_begin[slots] = total;
+
+	s.cand.resize(total);
+	uint32_t fill[2 * kMaxSelect];
+	std::copy(slot_begin, slot_begin + slots, fill);
+	for (int t = 0; t < n; ++t) {
+		uint32_t k = FloatKey(v[t]);
+		if (int j = s.slot[(k - kmin) >> shift]) s.cand[fill[j - 1]++] = k;
+	}
+
+	// ranks are ascending, so each selection only has to look right of the previous one
+	// in the same bucket
+	float val[2 * kMaxSelect];
+	uint32_t done[2 * kMaxSelect];
+	std::copy(slot_begin, slot_begin + slots, done);
+	for (int r = 0; r < nr; ++r) {
+		const int j = s.slot[bucket[r]] - 1;
+		uint32_t* c = s.cand.data();
+		uint32_t pos = slot_begin[j] + uint32_t(want[r].rank - cum_at[r]);
+		if (pos >= done[j]) { std::nth_element(c + done[j], c + pos, c + slot_begin[j + 1]); done[j] = pos + 1; }
+		val[want[r].q] = KeyFloat(c[pos]);
+	}
+	for (int q = 0; q < np; ++q) {
+		size_t r = size_t((pct[q] / 100.f) * (n - 1));
+		out[q] = r + 1 < size_t(n) ? val[2 * q] * (1.f - frac[q]) + val[2 * q + 1] * frac[q] : val[2 * q];
+	}
+}
+
+// Same values as FillBandPoint without sorting, v is left untouched.
+inline void FillBandPointSelect(PathBands& bands, int i, const float* v, int n, SelectScratch& s) {
+	static constexpr float kPct[5] = { 10, 25, 50, 75, 90 };
+	float q[5];
+	SelectPercentiles(v, n, kPct, q, 5, s);
+	bands.p10[i] = q[0]; bands.p25[i] = q[1]; bands.p50[i] = q[2]; bands.p75[i] = q[3]; bands.p90[i] = q[4];
+}
+
+// every point of a step-major snapshot (points x trials), in parallel over points once
+// the work pays for waking the pool (~0.3 ms of selection)
+inline void FillBands(PathBands& bands, const float* snap, int trials, int threads = 0) {
+	constexpr int kChunk = 16;
+	const int points = bands.steps, chunks = (points + kChunk - 1) / kChunk;
+	if (size_t(points) * trials < (size_t(1) << 16)) threads = 1;
+	TaskPool::ParallelFor(chunks, [&](int c) {
+		SelectScratch s;
+		for (int i = c * kChunk; i < std::min(points, (c + 1) * kChunk); ++i) FillBandPointSelect(bands, i, snap + size_t(i) * trials, trials, s);
+	}, threads);
+}
+
+inline PathBands SimulatePathBands(const Game& g, const SessionInput& in, const BandResolution& res = {}, PathArena* arena = nullptr) {
+	SP_PROFILE_SCOPE("SimulatePathBands");
+	BandSetup b = PrepareBands(g, in, res);
+	const int points = (int)b.idx.size(), trials = b.trials;
+
+	// step-major: snap[k * trials + t] is trial t at point k
+	const size_t count = size_t(points) * trials;
+	std::vector<float> local;
+	float* snap = arena ? arena->Acquire(count) : nullptr;
+	if (!snap) { local.resize(count); snap = local.data(); SP_COUNT(BytesAllocated, count * sizeof(float)); }
+
+	SimulateBandTrials(g, in, b, 0, trials, [&](int k, int t, float v) { snap[size_t(k) * trials + t] = v; });
+
+	SP_PROFILE_SCOPE("Percentiles");
+	PathBands bands = AllocBands(b);
+	FillBands(bands, snap, trials);
+	return bands;
+}
+
+// Fixed-bin histogram per snapshot point; memory is points * bins, independent of trials.
+// Bankroll is bounded by [0, take-profit] so the range is known up front.
+struct BandSketch {
+	int points = 0, bins = 0;
+	float lo = 0.f, hi = 1.f;
+	std::vector<uint32_t> counts; // points x bins
 
-	for (int i = 0; i <= spins; ++i) {
-		auto v = std::move(snapshots[i]); // copy -> move to sort
-		bands.p10[i] = Percentile(v, 10);
-		bands.p25[i] = Percentile(v, 25);
-		bands.p50[i] = Percentile(v, 50);
-		bands.p75[i] = Percentile(v, 75);
-		bands.p90[i] = Percentile(v, 90);
+	void Reset(int n_points, int n_bins, float lo_, float hi_) {
+		points = n_points; bins = n_bins; lo = lo_; hi = std::max(hi_, lo_ + 1e-3f);
+		counts.assign(size_t(points) * bins, 0u);
+	}
+	void Add(int k, float v) {
+		int b = int((v - lo) / (hi - lo) * bins);
+		counts[size_t(k) * bins + std::clamp(b, 0, bins - 1)]++;
 	}
+	// interpolated inside the bin holding rank p
+	float Quantile(int k, float p) const {
+		const uint32_t* c = counts.data() + size_t(k) * bins;
+		uint64_t n = 0; for (int i = 0; i < bins; ++i) n += c[i];
+		if (!n) return lo;
+		double target = (p / 100.0) * double(n), acc = 0.0, w = (hi - lo) / bins;
+		for (int i = 0; i < bins; ++i) {
+			if (acc + c[i] >= target && c[i]) return float(lo + w * (i + (target - acc) / c[i]));
+			acc += c[i];
+		}
+		return hi;
+	}
+};
+
+inline void FillBandPoint(PathBands& bands, int i, const BandSketch& sk) {
+	bands.p10[i] = sk.Quantile(i, 10);
+	bands.p25[i] = sk.Quantile(i, 25);
+	bands.p50[i] = sk.Quantile(i, 50);
+	bands.p75[i] = sk.Quantile(i, 75);
+	bands.p90[i] = sk.Quantile(i, 90);
+}
+
+inline PathBands SimulatePathBandsSketch(const Game& g, const SessionInput& in, const BandResolution& res = {}, int bins = 512) {
+	SP_PROFILE_SCOPE("SimulatePathBands");
+	BandSetup b = PrepareBands(g, in, res);
+	BandSketch sk; sk.Reset((int)b.idx.size(), bins, 0.f, b.tp);
+	SP_COUNT(BytesAllocated, sk.counts.size() * sizeof(uint32_t));
+	SimulateBandTrials(g, in, b, 0, b.trials, [&](int k, int, float v) { sk.Add(k, v); });
+
+	SP_PROFILE_SCOPE("Percentiles");
+	PathBands bands = AllocBands(b);
+	for (int i = 0; i < bands.steps; ++i) FillBandPoint(bands, i, sk);
 	return bands;
-}
\ No newline at end of file
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "Extras.h"
+#include <algorithm>
+
+// Bet sizing policies for the trial loops. Each policy is a CRTP class with Want(bank)
+// (stake it would like) and OnSpin(win) (state update); BetPolicy turns that into an
+// affordable stake, so the per-spin update inlines into SimulateSessionTrials, the band
+// and fixed-point loops and RunStrategyTrial. VisitStrategy maps the runtime choice onto
+// the concrete type once per batch of trials; FlatBet folds back into a fixed stake.
+
+inline const char* StrategyName(BetStrategy s) {
+	switch (s) {
+	case BetStrategy::Proportional: return "Proportional";
+	case BetStrategy::Kelly: return "Kelly";
+	case BetStrategy::Ramp: return "Ramp";
+	case BetStrategy::Martingale: return "Capped martingale";
+	default: return "Flat";
+	}
+}
+
+// params resolved against one session
+struct StrategySetup {
+	StrategyParams p;
+	float base = 1.f;     // plan bet
+	float min_bet = 1.f;  // session ends once this is unaffordable
+	float fraction = 0.f; // proportional / Kelly share of the bankroll
+};
+
+// Kelly needs a positive edge; without one its growth-optimal stake is zero
+inline bool KellyHasEdge(const Game& g) {
+	float rtp_eff, cost_mult;
+	ComputeEffectiveGame(g, rtp_eff, cost_mult);
+	return rtp_eff > 1.f;
+}
+
+// bet: the plan's flat stake, which the policies scale from
+inline StrategySetup PrepareStrategy(const StrategyParams& p, const Game& g, const SessionInput& in, float bet, float cost_mult, const ExtraProcess& extras) {
+	StrategySetup s;
+	s.p = p;
+	s.base = bet;
+	const bool scaled = p.kind == BetStrategy::Proportional || p.kind == BetStrategy::Kelly;
+	s.min_bet = scaled ? std::max(1e-4f, s.base * p.min_bet_frac) : s.base;
+	if (p.kind == BetStrategy::Proportional) s.fraction = p.fraction > 0.f ? p.fraction : s.base / std::max(1.f, in.start_bankroll);
+	if (p.kind == BetStrategy::Kelly) {
+		// growth-optimal share mu / sigma^2 per unit staked; 0 on a negative edge, where
+		// the policy sits at the minimum bet (the editor doesn't offer it there)
+		const SpinMoments m = SpinIncrementMoments(g, s.base, cost_mult, extras);
+		s.fraction = m.var > 0.0 ? float(std::max(0.0, p.kelly_scale * m.mean * s.base / m.var)) : 0.f;
+	}
+	return s;
+}
+
+template<class D>
+struct BetPolicy {
+	float base, min_bet;
+	BetPolicy(float base_, float min_bet_) : base(base_), min_bet(min_bet_) {}
+
+	// stake for the next spin; all-in when the wanted stake is unaffordable, 0 to stop
+	float Bet(double bank, float cost_mult) {
+		if (bank < min_bet * cost_mult) return 0.f;
+		float bet = std::max(min_bet, static_cast<D*>(this)->Want(bank));
+		if (bank < bet * cost_mult) bet = std::max(min_bet, float(bank / cost_mult));
+		return bet;
+	}
+	void Settle(bool win) { static_cast<D*>(this)->OnSpin(win); }
+};
+
+struct FlatBet : BetPolicy<FlatBet> {
+	explicit FlatBet(const StrategySetup& s) : BetPolicy(s.base, s.base) {}
+	float Want(double) const { return base; }
+	void OnSpin(bool) {}
+};
+
+struct ProportionalBet : BetPolicy<ProportionalBet> {
+	float fraction;
+	explicit ProportionalBet(const StrategySetup& s) : BetPolicy(s.base, s.min_bet), fraction(s.fraction) {}
+	float Want(double bank) const { return float(fraction * bank); }
+	void OnSpin(bool) {}
+};
+
+struct KellyBet : BetPolicy<KellyBet> {
+	float fraction;
+	explicit KellyBet(const StrategySetup& s) : BetPolicy(s.base, s.min_bet), fraction(s.fraction) {}
+	float Want(double bank) const { return float(fraction * bank); }
+	void OnSpin(bool) {}
+};
+
+// grows the bet by mult after each win (or loss) up to steps times, back to base otherwise
+struct RampBet : BetPolicy<RampBet> {
+	float mult, cur;
+	int steps, level = 0;
+	bool on_win;
+	explicit RampBet(const StrategySetup& s) : BetPolicy(s.base, s.base), mult(s.p.ramp_mult), cur(s.base), steps(s.p.ramp_steps), on_win(s.p.ramp_on_win) {}
+	float Want(double) const { return cur; }
+	void OnSpin(bool win) {
+		if (win != on_win) { level = 0; cur = base; }
+		else if (level < steps) { ++level; cur *= mult; }
+	}
+};
+
+// doubles after each loss, back to base on a win or once max_doublings losses ran out
+struct MartingaleBet : BetPolicy<MartingaleBet> {
+	float cur;
+	int max_doublings, level = 0;
+	explicit MartingaleBet(const StrategySetup& s) : BetPolicy(s.base, s.base), cur(s.base), max_doublings(s.p.max_doublings) {}
+	float Want(double) const { return cur; }
+	void OnSpin(bool win) {
+		if (win || level >= max_doublings) { level = 0; cur = base; }
+		else { ++level; cur *= 2.f; }
+	}
+};
+
+template<class F>
+inline decltype(auto) VisitStrategy(const StrategySetup& s, F&& f) {
+	switch (s.p.kind) {
+	case BetStrategy::Proportional: return f(ProportionalBet(s));
+	case BetStrategy::Kelly: return f(KellyBet(s));
+	case BetStrategy::Ramp: return f(RampBet(s));
+	case BetStrategy::Martingale: return f(MartingaleBet(s));
+	default: return f(FlatBet(s));
+	}
+}
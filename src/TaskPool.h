@@ -0,0 +1,124 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ParallelFor with range stealing: every worker starts with an even slice of [0, n) and
+// pops indices from its front; an idle worker steals the back half of the fullest slice.
+// Good for uneven items (games that bust in 10 spins vs ones that run the full cap).
+//
+// Workers are long-lived and shared by every caller: a call queues a job, runs slice 0
+// itself and is joined by whichever workers are idle. Slices nobody joins get stolen, so
+// a call never waits on a busy pool, and nested or concurrent calls (ranking, campaign and
+// compare threads at once) cannot deadlock.
+class TaskPool {
+public:
+	static int DefaultThreads() { return std::max(1u, std::thread::hardware_concurrency()); }
+
+	template<class F>
+	static void ParallelFor(int n, F&& f, int threads = 0) {
+		if (n <= 0) return;
+		int nt = std::clamp(threads > 0 ? threads : DefaultThreads(), 1, n);
+		if (nt == 1) { for (int i = 0; i < n; ++i) f(i); return; }
+
+		std::vector<Slice> slices(nt);
+		for (int w = 0; w < nt; ++w) { slices[w].begin = int(int64_t(n) * w / nt); slices[w].end = int(int64_t(n) * (w + 1) / nt); }
+
+		Job job;
+		job.slots = nt;
+		job.work = [&](int w) {
+			for (;;) {
+				int i = slices[w].Pop();
+				if (i < 0 && !Steal(slices, w)) return;
+				if (i >= 0) f(i);
+			}
+		};
+		Instance().Run(job);
+	}
+
+private:
+	struct Slice {
+		std::mutex m;
+		int begin = 0, end = 0;
+		int Pop() { std::lock_guard<std::mutex> lk(m); return begin < end ? begin++ : -1; }
+		int Left() { std::lock_guard<std::mutex> lk(m); return end - begin; }
+	};
+
+	struct Job {
+		std::function<void(int)> work;
+		int slots = 1;  // participants wanted, the caller included
+		int joined = 1; // slot handed to the next worker
+		int active = 0; // workers still inside work()
+	};
+
+	std::mutex m_;
+	std::condition_variable wake_, done_;
+	std::deque<Job*> queue_; // jobs with slots left
+	std::vector<std::thread> workers_;
+	bool stop_ = false;
+
+	static TaskPool& Instance() { static TaskPool pool; return pool; }
+
+	~TaskPool() {
+		{ std::lock_guard<std::mutex> lk(m_); stop_ = true; }
+		wake_.notify_all();
+		for (auto& t : workers_) t.join();
+	}
+
+	void Run(Job& job) {
+		{
+			std::lock_guard<std::mutex> lk(m_);
+			while ((int)workers_.size() < job.slots - 1) workers_.emplace_back([this] { WorkerLoop(); });
+			queue_.push_back(&job);
+		}
+		wake_.notify_all();
+		job.work(0);
+		std::unique_lock<std::mutex> lk(m_);
+		// close the job to late workers, then wait out the ones inside it
+		if (auto it = std::find(queue_.begin(), queue_.end(), &job); it != queue_.end()) queue_.erase(it);
+		done_.wait(lk, [&] { return job.active == 0; });
+	}
+
+	void WorkerLoop() {
+		std::unique_lock<std::mutex> lk(m_);
+		for (;;) {
+			wake_.wait(lk, [&] { return stop_ || !queue_.empty(); });
+			if (stop_) return;
+			Job* job = queue_.front();
+			const int slot = job->joined++;
+			if (job->joined == job->slots) queue_.pop_front();
+			job->active++;
+			lk.unlock();
+			job->work(slot);
+			lk.lock();
+			if (--job->active == 0) done_.notify_all();
+		}
+	}
+
+	static bool Steal(std::vector<Slice>& slices, int self) {
+		for (;;) {
+			int victim = -1, most = 1;
+			for (int v = 0; v < (int)slices.size(); ++v) if (v != self) { int l = slices[v].Left(); if (l > most) { most = l; victim = v; } }
+			if (victim < 0) {
+				// nothing worth halving; take a single leftover item if there is one
+				for (int v = 0; v < (int)slices.size(); ++v) if (v != self && slices[v].Left() > 0) { victim = v; break; }
+				if (victim < 0) return false;
+			}
+			Slice& src = slices[victim];
+			Slice& dst = slices[self];
+			std::scoped_lock lk(src.m, dst.m);
+			int left = src.end - src.begin;
+			if (left <= 0) continue; // lost the race, look again
+			int take = std::max(1, left / 2);
+			dst.begin = src.end - take; dst.end = src.end;
+			src.end -= take;
+			return true;
+		}
+	}
+};
@@ -1,3 +1,4 @@
+#ifdef _WIN32
 #define NOMINMAX
 #include <windows.h>
 #include <d3d11.h>
@@ -8,6 +9,8 @@
 
 #include "Style.h"
 #include "App.h"
+#include "Cli.h"
+#include "FrameScheduler.h"
 
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -32,6 +35,10 @@ static void CreateRenderTarget();
 static void CleanupRenderTarget();
 
 int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int) {
+	CliOptions opts;
+	int cli = RunCli(__argc, __argv, opts);
+	if (cli >= 0) return cli;
+
 	WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, WndProc, 0L, 0L, GetModuleHandle(NULL), NULL, NULL, NULL, NULL, _T("SlotPlannerClass"), NULL };
 	RegisterClassEx(&wc);
 
@@ -52,12 +59,24 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int) {
 	ImGui_ImplWin32_Init(hwnd);
 	ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
 
+	// declared before the app: worker threads may still call Wake() while it shuts down
+	FrameScheduler sched;
 	SlotPlannerApp app;
+	if (!opts.catalog.empty()) app.OpenCatalog(opts.catalog);
+
+	// Main loop: only render when input, a background job or an active widget asks for it
+	sched.SetWakeHook([hwnd] { PostMessage(hwnd, WM_NULL, 0, 0); });
+	app.SetWakeCallback([&sched] { sched.Wake(); });
 
-	// Main loop
 	bool done = false;
 	while (!done) {
-		MSG msg; while (PeekMessage(&msg, NULL, 0U, 0U, PM_REMOVE)) { if (msg.message == WM_QUIT) done = true; TranslateMessage(&msg); DispatchMessage(&msg); } if (done) break;
+		if (!sched.NeedsFrame()) {
+			int timeout = sched.IdleTimeoutMs();
+			MsgWaitForMultipleObjects(0, NULL, FALSE, timeout < 0 ? INFINITE : (DWORD)timeout, QS_ALLINPUT);
+		}
+		MSG msg; while (PeekMessage(&msg, NULL, 0U, 0U, PM_REMOVE)) { if (msg.message == WM_QUIT) done = true; if (msg.message != WM_NULL) sched.OnInput(); TranslateMessage(&msg); DispatchMessage(&msg); } if (done) break;
+		if (!sched.NeedsFrame()) continue;
+		sched.BeginFrame();
 
 		ImGui_ImplDX11_NewFrame(); ImGui_ImplWin32_NewFrame(); ImGui::NewFrame();
 
@@ -70,6 +89,10 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR, int) {
 		ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 
 		g_pSwapChain->Present(1, 0); // VSync
+
+		sched.SetActive(app.Busy() || ImGui::GetIO().WantTextInput);
+		if (app.Simulating()) sched.RequestFrame();
+		sched.FrameDone();
 	}
 
 	// Cleanup
@@ -100,4 +123,18 @@ static bool CreateDeviceD3D(HWND hWnd) {
 }
 static void CleanupDeviceD3D() { CleanupRenderTarget(); if (g_pSwapChain) { g_pSwapChain->Release(); g_pSwapChain = nullptr; } if (g_pd3dDeviceContext) { g_pd3dDeviceContext->Release(); g_pd3dDeviceContext = nullptr; } if (g_pd3dDevice) { g_pd3dDevice->Release(); g_pd3dDevice = nullptr; } }
 static void CreateRenderTarget() { ID3D11Texture2D* pBackBuffer = nullptr; g_pSwapChain->GetBuffer(0, IID_PPV_ARGS(&pBackBuffer)); g_pd3dDevice->CreateRenderTargetView(pBackBuffer, NULL, &g_mainRenderTargetView); pBackBuffer->Release(); }
-static void CleanupRenderTarget() { if (g_mainRenderTargetView) { g_mainRenderTargetView->Release(); g_mainRenderTargetView = nullptr; } }
\ No newline at end of file
+static void CleanupRenderTarget() { if (g_mainRenderTargetView) { g_mainRenderTargetView->Release(); g_mainRenderTargetView = nullptr; } }
+
+#else
+#include <cstdio>
+#include "Cli.h"
+
+// no window backend off Windows: command-line tools and the headless UI bench only
+int main(int argc, char** argv) {
+	CliOptions opts;
+	int cli = RunCli(argc, argv, opts);
+	if (cli >= 0) return cli;
+	std::fprintf(stderr, "SlotPlanner: no window backend on this platform. Try --bench-ui or --rank demo.\n");
+	return 1;
+}
+#endif